@@ -52,7 +52,11 @@
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/wait.h>
 #include <dirent.h>
+#if defined HAVE_SYS_INOTIFY_H
+# include <sys/inotify.h>
+#endif	/* HAVE_SYS_INOTIFY_H */
 #if defined __FreeBSD__
 # include <sys/syscall.h>
 #endif	/* __FreeBSD__ */
@@ -62,12 +66,12 @@
 #ifdef HAVE_SYS_UCRED_H
 # include <sys/ucred.h>
 #endif	/* HAVE_SYS_UCRED_H */
-#if defined HAVE_SENDFILE
-# include <sys/sendfile.h>
-#endif	/* HAVE_SENDFILE */
 #if defined HAVE_PATHS_H
 # include <paths.h>
 #endif	/* HAVE_PATHS_H */
+#if defined HAVE_PTHREAD
+# include <pthread.h>
+#endif	/* HAVE_PTHREAD */
 #include <spawn.h>
 #include <pwd.h>
 #include <grp.h>
@@ -79,6 +83,12 @@
 #include "nifty.h"
 #include "sock.h"
 #include "nedtrie.h"
+#include "twheel.h"
+#include "oidmap.h"
+#include "hist.h"
+#include "xjob.h"
+/* for queue file signatures */
+#include "hash.h"
 /* for rescheduling */
 #include "evfilt.h"
 /* for user/group mappings */
@@ -101,6 +111,13 @@
 
 typedef struct _task_s *_task_t;
 
+/* per-task latencies, only kept when asked for */
+struct task_hist_s {
+	struct hist_s lag;
+	struct hist_s spawn;
+	struct hist_s run;
+};
+
 typedef struct {
 	uid_t u;
 	gid_t g;
@@ -108,11 +125,16 @@ typedef struct {
 	const char *sh;
 } ncred_t;
 
-/* linked list of ev_periodic objects */
+/* linked list of timing wheel nodes */
 struct _task_s {
-	/* beef data for libev and book-keeping */
-	ev_periodic w;
+	/* beef data for the scheduler and book-keeping */
+	struct twnode_s w;
+	/* for tasks with slack, the start of their window */
+	struct twnode_s lw;
 	_task_t next;
+	/* other tasks of the same owner */
+	_task_t onext;
+	_task_t oprev;
 
 	/* currently scheduled run-time */
 	echs_instant_t cur;
@@ -125,8 +147,17 @@ struct _task_s {
 	size_t nrun;
 	/* number of concurrent runs */
 	size_t nsim;
+	/* set when the stream is exhausted but children are still running */
+	bool donep;
 
 	ncred_t dflt_cred;
+
+	/* serialised task, for when the stream has been dropped */
+	char *dry;
+	size_t ndry;
+
+	/* latencies of this task, or NULL */
+	struct task_hist_s *hist;
 };
 
 struct _echsd_s {
@@ -134,6 +165,7 @@ struct _echsd_s {
 	ev_signal sighup;
 	ev_signal sigterm;
 	ev_signal sigpipe;
+	ev_signal sigusr1;
 
 	/* checkpoint timer */
 	ev_timer cptim;
@@ -161,6 +193,69 @@ static struct ucred meself;
 static char hname[HOST_NAME_MAX];
 static size_t hnamez;
 
+/* daemon statistics, served under /stats, everything's counted as it
+ * happens so serving them needs neither checkpoints nor table scans */
+static struct {
+	/* open connections */
+	size_t nconn;
+	/* times we stopped accepting because of too many connections */
+	size_t nconn_defer;
+	/* jobs handed to echsx, jobs that couldn't be and jobs in flight */
+	size_t nspawn;
+	size_t nspawnerr;
+	size_t nrunning;
+	/* runs skipped because too many were in flight */
+	size_t nskip;
+	/* runs that had to queue for the job budget, and runs queued */
+	size_t nqueue;
+	size_t nqueued;
+	/* echsx processes started */
+	size_t nxwork;
+	/* checkpoints taken, duration of the last one and of all of them */
+	size_t nchkpnt;
+	ev_tstamp chkpnt_last;
+	ev_tstamp chkpnt_total;
+	/* bytes written to the journal and to snapshots */
+	size_t nwalb;
+	size_t nsnapb;
+	/* schedule timer expiries, and how many there'd be without slack */
+	size_t nwake;
+	size_t nwake_nom;
+	ev_tstamp beg;
+
+	/* latencies, in usec: scheduled vs actual start of a job, time
+	 * spent serialising it, time spent handing it over to echsx and
+	 * time until echsx reported back */
+	struct hist_s lag;
+	struct hist_s vtod;
+	struct hist_s spawn;
+	struct hist_s run;
+	/* time runs spent in the run queue */
+	struct hist_s qwait;
+} dstats;
+/* keep latencies per task too? */
+static bool task_histp;
+
+static inline __attribute__((const)) uint64_t
+usec(ev_tstamp d)
+{
+	return d > 0 ? (uint64_t)(d * 1000000) : 0U;
+}
+
+static inline __attribute__((const)) double
+secs(uint64_t us)
+{
+	return (double)us / 1000000;
+}
+
+static double
+hist_secs(const struct hist_s *h, unsigned int pm)
+{
+/* H's PM-th permille in seconds */
+	const uint64_t us = hist_quantile(h, (double)pm / 1000);
+	return secs(us);
+}
+
 
 static inline size_t
 xstrlncpy(char *restrict dst, size_t dsz, const char *src, size_t ssz)
@@ -243,6 +338,7 @@ block_sigs(void)
 
 	sigemptyset(fatal_signal_set);
 	sigaddset(fatal_signal_set, SIGHUP);
+	sigaddset(fatal_signal_set, SIGUSR1);
 	sigaddset(fatal_signal_set, SIGQUIT);
 	sigaddset(fatal_signal_set, SIGINT);
 	sigaddset(fatal_signal_set, SIGTERM);
@@ -702,7 +798,7 @@ make_socket(void)
 	sz += sizeof(sa.sun_family);
 	if (UNLIKELY(bind(s, (struct sockaddr*)&sa, sz) < 0)) {
 		goto fail;
-	} else if (listen(s, 5U) < 0) {
+	} else if (listen(s, SOMAXCONN) < 0) {
 		goto fail;
 	}
 	return s;
@@ -734,13 +830,79 @@ free_socket(int s)
 #define NOT_A_UID	((uid_t)-1)
 #define NOT_A_GID	((gid_t)-1)
 
+static inline echs_oid_t
+ownr_key(uid_t u)
+{
+/* oidmaps won't take 0 as key but root would like to be in there,
+ * NOT_A_UID on the other hand wraps around and stays out */
+	return (uid_t)(u + 1U);
+}
+
+static inline uid_t
+ownr_uid(echs_oid_t k)
+{
+	return (uid_t)(k - 1U);
+}
+
+/* passwd cache, when loading the queues we'd ask the same questions
+ * over and over again (several times per task), so for the duration
+ * of the load we remember the answers, uid -> ncred_t */
+static oidmap_t pwcache;
+
+static void
+make_pwcache(void)
+{
+	pwcache = make_oidmap(64U);
+	return;
+}
+
+static void
+free_pwcache(void)
+{
+	ncred_t *c;
+
+	if (pwcache == NULL) {
+		return;
+	}
+	for (oidmap_iter_t i = 0U; (c = oidmap_next(&i, pwcache, NULL));) {
+		free(c);
+	}
+	free_oidmap(pwcache);
+	pwcache = NULL;
+	return;
+}
+
 static ncred_t
 compl_uid(uid_t u)
 {
 	struct passwd *p;
-
-	if (UNLIKELY(u == NOT_A_UID || (p = getpwuid(u)) == NULL)) {
+	ncred_t *c;
+
+	if (UNLIKELY(u == NOT_A_UID)) {
+		return (ncred_t){.u = NOT_A_UID};
+	} else if (pwcache != NULL &&
+		   (c = oidmap_get(pwcache, ownr_key(u))) != NULL) {
+		return *c;
+	} else if (UNLIKELY((p = getpwuid(u)) == NULL)) {
 		return (ncred_t){NOT_A_UID};
+	} else if (pwcache == NULL) {
+		;
+	} else with (size_t wz = strlen(p->pw_dir) + 1U,
+		     sz = strlen(p->pw_shell) + 1U) {
+		/* strings go right behind the cell */
+		char *wd;
+
+		if (UNLIKELY((c = malloc(sizeof(*c) + wz + sz)) == NULL)) {
+			break;
+		}
+		wd = memcpy(c + 1U, p->pw_dir, wz);
+		*c = (ncred_t){
+			p->pw_uid, p->pw_gid,
+			wd, memcpy(wd + wz, p->pw_shell, sz)
+		};
+		if (UNLIKELY(oidmap_put(pwcache, ownr_key(u), c) < 0)) {
+			free(c);
+		}
 	}
 	return (ncred_t){p->pw_uid, p->pw_gid, p->pw_dir, p->pw_shell};
 }
@@ -798,88 +960,83 @@ struct tlst_s {
 	size_t size;
 };
 
-/* mapping from oid to task */
-struct tmap_s {
-	echs_toid_t oid;
-	_task_t t;
-};
-
 static struct tlst_s *tpools;
 static size_t ntpools;
 static size_t ztpools;
 
-static struct tmap_s *task_ht;
-static size_t ztask_ht;
+/* mapping from oid to task */
+static oidmap_t task_ht;
+/* mapping from owner to their first task */
+static oidmap_t ownr_ht;
 
 static int
 ini_task_ht(void)
 {
-	if (UNLIKELY(!ztask_ht)) {
+	if (UNLIKELY(task_ht == NULL)) {
 		/* instantiate hash table */
-		const size_t iniz = 16U;
-
-		task_ht = calloc(iniz, sizeof(*task_ht));
+		task_ht = make_oidmap(ECHS_TASK_POOL_INIZ);
 		if (UNLIKELY(task_ht == NULL)) {
 			/* I want to kill myself */
 			return -1;
 		}
-		/* that went well */
-		ztask_ht = iniz;
+	}
+	if (UNLIKELY(ownr_ht == NULL)) {
+		ownr_ht = make_oidmap(64U);
+		if (UNLIKELY(ownr_ht == NULL)) {
+			return -1;
+		}
 	}
 	return 0;
 }
 
-static ssize_t
-put_task_slot(echs_toid_t oid)
-{
-/* find slot for OID for putting
- * if collision recommend new size for task_ht */
-	size_t slot = oid & (ztask_ht - 1ULL);
-	const echs_toid_t toid = task_ht[slot].oid;
-
-	if (LIKELY(!toid)) {
-		return slot;
-	} else if (UNLIKELY(toid == oid)) {
-		/* huh? that's very inconsistent */
-		return slot;
-	}
-	/* calc new size */
-	with (size_t nuz = 1ULL << (__builtin_ctzll(toid ^ oid) + 1U)) {
-		struct tmap_s *nut = calloc(nuz, sizeof(*task_ht));
-
-		assert(nuz > ztask_ht);
-		if (UNLIKELY(nut == NULL)) {
-			/* ah well */
-			return -1;
-		}
-		for (size_t i = 0U; i < ztask_ht; i++) {
-			/* we can't get any additional collisions */
-			if (task_ht[i].oid) {
-				const size_t si = task_ht[i].oid & (nuz - 1ULL);
-				nut[si] = task_ht[i];
-			}
-		}
-		/* reass */
-		free(task_ht);
-		task_ht = nut;
-		ztask_ht = nuz;
-		ECHS_NOTI_LOG("resized table of tasks to %zu", ztask_ht);
-		slot = oid & (ztask_ht - 1ULL);
-		assert(!task_ht[slot].oid);
+static _task_t
+ownr_tasks(uid_t u)
+{
+/* return the first task of owner U, go through them with ->onext */
+	if (UNLIKELY(ownr_ht == NULL)) {
+		return NULL;
 	}
-	return slot;
+	return oidmap_get(ownr_ht, ownr_key(u));
 }
 
-static size_t
-get_task_slot(echs_toid_t oid)
+static int
+link_task(_task_t t)
 {
-/* find slot for OID for getting */
-	for (size_t i = 16U/*retries*/, slot = oid & (ztask_ht - 1U); i; i--) {
-		if (task_ht[slot].oid == oid) {
-			return slot;
-		}
+/* put T at the front of its owner's list */
+	const echs_oid_t k = ownr_key(t->dflt_cred.u);
+	_task_t nx = oidmap_get(ownr_ht, k);
+
+	if (UNLIKELY(oidmap_put(ownr_ht, k, t) < 0)) {
+		return -1;
 	}
-	return (size_t)-1ULL;
+	t->onext = nx;
+	t->oprev = NULL;
+	if (nx != NULL) {
+		nx->oprev = t;
+	}
+	return 0;
+}
+
+static void
+unlink_task(_task_t t)
+{
+	const echs_oid_t k = ownr_key(t->dflt_cred.u);
+
+	if (t->oprev != NULL) {
+		t->oprev->onext = t->onext;
+	} else if (oidmap_get(ownr_ht, k) != t) {
+		/* never made it into the list */
+		return;
+	} else if (t->onext != NULL) {
+		(void)oidmap_put(ownr_ht, k, t->onext);
+	} else {
+		(void)oidmap_del(ownr_ht, k);
+	}
+	if (t->onext != NULL) {
+		t->onext->oprev = t->oprev;
+	}
+	t->onext = t->oprev = NULL;
+	return;
 }
 
 static _task_t
@@ -934,14 +1091,8 @@ static _task_t
 make_task(echs_toid_t oid)
 {
 /* create one task */
-	ssize_t slot = put_task_slot(oid);
 	_task_t res;
 
-	if (UNLIKELY(slot < 0)) {
-		ECHS_ERR_LOG("cannot find slot for task %lx", oid);
-		return NULL;
-	}
-
 	if (UNLIKELY(!nfree_tasks)) {
 		/* put some more task objects in the task pool */
 		const size_t adz = zfree_tasks ?: ECHS_TASK_POOL_INIZ;
@@ -957,27 +1108,40 @@ make_task(echs_toid_t oid)
 
 	/* pop off the free list */
 	res = free_tasks;
+	if (UNLIKELY(oidmap_put(task_ht, oid, res) < 0)) {
+		ECHS_ERR_LOG("cannot find slot for task %lx", oid);
+		return NULL;
+	}
 	free_tasks = free_tasks->next;
 	nfree_tasks--;
 
-	task_ht[slot] = (struct tmap_s){oid, res};
 	memset(res, 0, sizeof(*res));
 	return res;
 }
 
+static void
+unmake_task(_task_t t, echs_toid_t oid)
+{
+/* give back task T that was made for OID but never filled in */
+	if (UNLIKELY(oidmap_del(task_ht, oid) != t)) {
+		ECHS_NOTI_LOG("inconsistent table of tasks");
+	}
+	t->next = free_tasks;
+	free_tasks = t;
+	nfree_tasks++;
+	return;
+}
+
 static void
 free_task(_task_t t)
 {
 /* hand task T over to free list */
 	/* free from our task hash table */
-	with (size_t i = get_task_slot(t->t->oid)) {
-		if (UNLIKELY(i >= ztask_ht || task_ht[i].oid != t->t->oid)) {
-			/* that's no good :O */
-			ECHS_NOTI_LOG("inconsistent table of tasks");
-			break;
-		}
-		task_ht[i] = (struct tmap_s){0U, NULL};
+	if (UNLIKELY(oidmap_del(task_ht, t->t->oid) != t)) {
+		/* that's no good :O */
+		ECHS_NOTI_LOG("inconsistent table of tasks");
 	}
+	unlink_task(t);
 
 	if (LIKELY(t->dflt_cred.wd != NULL)) {
 		free(deconst(t->dflt_cred.wd));
@@ -985,6 +1149,12 @@ free_task(_task_t t)
 	if (LIKELY(t->dflt_cred.sh != NULL)) {
 		free(deconst(t->dflt_cred.sh));
 	}
+	if (t->dry != NULL) {
+		free(t->dry);
+	}
+	if (t->hist != NULL) {
+		free(t->hist);
+	}
 	free_echs_task(t->t);
 
 	t->next = free_tasks;
@@ -993,36 +1163,80 @@ free_task(_task_t t)
 	return;
 }
 
+static struct task_hist_s*
+task_hist(_task_t t)
+{
+/* T's latency histograms, they're allocated on first use */
+	if (LIKELY(!task_histp)) {
+		return NULL;
+	} else if (t->hist == NULL) {
+		t->hist = calloc(1U, sizeof(*t->hist));
+	}
+	return t->hist;
+}
+
 static _task_t
 get_task(echs_toid_t oid)
 {
 /* find the task with oid OID. */
-	size_t slot;
-
-	if (UNLIKELY(!ztask_ht)) {
-		return NULL;
-	} else if (UNLIKELY((slot = get_task_slot(oid)) >= ztask_ht)) {
-		/* not resizing now */
-		return NULL;
-	} else if (!task_ht[slot].oid) {
-		/* not found */
+	if (UNLIKELY(task_ht == NULL)) {
 		return NULL;
 	}
-	return task_ht[slot].t;
+	return oidmap_get(task_ht, oid);
 }
 
 static void
 free_task_ht(void)
 {
 	if (LIKELY(task_ht != NULL)) {
-		free(task_ht);
+		free_oidmap(task_ht);
 		task_ht = NULL;
 	}
+	if (LIKELY(ownr_ht != NULL)) {
+		free_oidmap(ownr_ht);
+		ownr_ht = NULL;
+	}
 	return;
 }
 
+/* VTODOs go out in one frame, so they're rendered into memory first */
+static struct {
+	char buf[XJOB_MAXZ];
+	size_t bi;
+} vt_aux;
+
+static __attribute__((format(printf, 1, 2))) int
+vtprintf(const char *fmt, ...)
+{
+	const size_t bz = sizeof(vt_aux.buf) - vt_aux.bi;
+	va_list vap;
+	int tp;
+
+	va_start(vap, fmt);
+	tp = vsnprintf(vt_aux.buf + vt_aux.bi, bz, fmt, vap);
+	va_end(vap);
+
+	if (UNLIKELY(tp < 0 || (size_t)tp >= bz)) {
+		/* doesn't fit */
+		return -1;
+	}
+	vt_aux.bi += tp;
+	return 0;
+}
+
+static ssize_t
+vtwrite(const char *str, size_t len)
+{
+	if (UNLIKELY(vt_aux.bi + len > sizeof(vt_aux.buf))) {
+		return -1;
+	}
+	memcpy(vt_aux.buf + vt_aux.bi, str, len);
+	vt_aux.bi += len;
+	return len;
+}
+
 static int
-vtodoify(int ofd, _task_t t)
+vtodoify(_task_t t)
 {
 	static const char vcal_hdr[] = "\
 BEGIN:VCALENDAR\n\
@@ -1038,22 +1252,22 @@ BEGIN:VTODO\n";
 END:VTODO\n";
 	int rc = 0;
 
-	/* bang and print VCAL header */
-	fdbang(ofd);
-	if (UNLIKELY(fdwrite(vcal_hdr, strlenof(vcal_hdr)) < 0)) {
+	/* start afresh and print VCAL header */
+	vt_aux.bi = 0U;
+	if (UNLIKELY(vtwrite(vcal_hdr, strlenof(vcal_hdr)) < 0)) {
 		rc--;
 		goto out;
 	}
 
 	/* start off with VTODO's header */
-	if (UNLIKELY(fdwrite(vtod_hdr, strlenof(vtod_hdr)) < 0)) {
+	if (UNLIKELY(vtwrite(vtod_hdr, strlenof(vtod_hdr)) < 0)) {
 		rc--;
 		goto out;
 	}
 
 
-	rc -= fdprintf("UID:%s\n", obint_name(t->t->oid)) < 0;
-	rc -= fdprintf("SUMMARY:%s\n", t->t->cmd) < 0;
+	rc -= vtprintf("UID:%s\n", obint_name(t->t->oid)) < 0;
+	rc -= vtprintf("SUMMARY:%s\n", t->t->cmd) < 0;
 	if (UNLIKELY(rc < 0)) {
 		goto out;
 	}
@@ -1070,10 +1284,10 @@ END:VTODO\n";
 			run_as.sh = t->dflt_cred.sh;
 		}
 
-		rc -= fdprintf("X-ECHS-SETUID:%u\n", (uid_t)run_as.u) < 0;
-		rc -= fdprintf("X-ECHS-SETGID:%u\n", (gid_t)run_as.g) < 0;
-		rc -= fdprintf("X-ECHS-SHELL:%s\n", run_as.sh) < 0;
-		rc -= fdprintf("LOCATION:%s\n", run_as.wd) < 0;
+		rc -= vtprintf("X-ECHS-SETUID:%u\n", (uid_t)run_as.u) < 0;
+		rc -= vtprintf("X-ECHS-SETGID:%u\n", (gid_t)run_as.g) < 0;
+		rc -= vtprintf("X-ECHS-SHELL:%s\n", run_as.sh) < 0;
+		rc -= vtprintf("LOCATION:%s\n", run_as.wd) < 0;
 	}
 	if (UNLIKELY(rc < 0)) {
 		goto out;
@@ -1082,145 +1296,60 @@ END:VTODO\n";
 	with (echs_idiff_t d = t->dur) {
 		const int s = d.d / 1000U + !!(d.d % 1000U);
 
-		rc -= fdprintf("DURATION:%d\n", s) < 0;
+		rc -= vtprintf("DURATION:%d\n", s) < 0;
 	}
 	with (unsigned int um = 0066U) {
 		if (t->t->umsk < 0777U) {
 			um = t->t->umsk;
 		}
-		rc -= fdprintf("X-ECHS-UMASK:0%o\n", um) < 0;
+		rc -= vtprintf("X-ECHS-UMASK:0%o\n", um) < 0;
 	}
 	if (UNLIKELY(rc < 0)) {
 		goto out;
 	}
 
-	rc -= fdprintf("X-ECHS-MAIL-RUN:%u\n", (unsigned int)t->t->mailrun) < 0;
-	rc -= fdprintf("X-ECHS-MAIL-OUT:%u\n", (unsigned int)t->t->mailout) < 0;
-	rc -= fdprintf("X-ECHS-MAIL-ERR:%u\n", (unsigned int)t->t->mailerr) < 0;
+	rc -= vtprintf("X-ECHS-MAIL-RUN:%u\n", (unsigned int)t->t->mailrun) < 0;
+	rc -= vtprintf("X-ECHS-MAIL-OUT:%u\n", (unsigned int)t->t->mailout) < 0;
+	rc -= vtprintf("X-ECHS-MAIL-ERR:%u\n", (unsigned int)t->t->mailerr) < 0;
 	if (t->t->in) {
-		rc -= fdprintf("X-ECHS-IFILE:%s\n", t->t->in) < 0;
+		rc -= vtprintf("X-ECHS-IFILE:%s\n", t->t->in) < 0;
 	}
 	if (t->t->out) {
-		rc -= fdprintf("X-ECHS-OFILE:%s\n", t->t->out) < 0;
+		rc -= vtprintf("X-ECHS-OFILE:%s\n", t->t->out) < 0;
 	}
 	if (t->t->err) {
-		rc -= fdprintf("X-ECHS-EFILE:%s\n", t->t->err) < 0;
+		rc -= vtprintf("X-ECHS-EFILE:%s\n", t->t->err) < 0;
 	}
 	if (t->t->org) {
-		rc -= fdprintf("ORGANIZER:%s\n", t->t->org) < 0;
+		rc -= vtprintf("ORGANIZER:%s\n", t->t->org) < 0;
 	} else if (hnamez) {
 		/* singleton, extend mailfrom by +HOSTNAME */
 		const int hnamei = hnamez;
-		rc -= fdprintf("ORGANIZER:echse+%.*s\n", hnamei, hname) < 0;
+		rc -= vtprintf("ORGANIZER:echse+%.*s\n", hnamei, hname) < 0;
 	} else {
 		static const char eorg[] = "ORGANIZER:echse\n";
-		rc -= fdwrite(eorg, strlenof(eorg)) < 0;
+		rc -= vtwrite(eorg, strlenof(eorg)) < 0;
 	}
 	for (size_t j = 0U, natt = t->t->att ? t->t->att->nl : 0U;
 	     j < natt; j++) {
-		rc -= fdprintf("ATTENDEE:%s\n", t->t->att->l[j]) < 0;
+		rc -= vtprintf("ATTENDEE:%s\n", t->t->att->l[j]) < 0;
 	}
 	if (UNLIKELY(rc < 0)) {
 		goto out;
 	}
 
-	/* and finish with VTODO's footer followed by a nice flush */
-	if (UNLIKELY(fdwrite(vtod_ftr, strlenof(vtod_ftr)) < 0)) {
+	/* and finish with VTODO's footer */
+	if (UNLIKELY(vtwrite(vtod_ftr, strlenof(vtod_ftr)) < 0)) {
 		rc--;
 		goto out;
-	} else if (UNLIKELY(fdwrite(vcal_ftr, strlenof(vcal_ftr)) < 0)) {
+	} else if (UNLIKELY(vtwrite(vcal_ftr, strlenof(vcal_ftr)) < 0)) {
 		rc--;
 		goto out;
 	}
-	rc -= fdflush() < 0;
 out:
 	return rc;
 }
 
-static pid_t
-run_task(_task_t t)
-{
-/* assumes ev_loop_fork() has been called */
-	static char *args[] = {
-		"echsx",
-		/* we want a vjournal log, defo defo */
-		"-v",
-		/* we maybe want to indicate a --no-run */
-		NULL,
-		NULL
-	};
-	char *const *env = deconst(t->t->env);
-	/* echsx's stdin */
-	int xin[2U];
-	/* for the journal */
-	posix_spawn_file_actions_t fa;
-	char vjfn[PATH_MAX];
-	int vjfd;
-	off_t vjof;
-	/* the actual process */
-	pid_t r;
-
-	/* set up pipe for echsx(1) */
-	if (UNLIKELY(pipe(xin) < 0)) {
-		ECHS_ERR_LOG("cannot set up pipe to echsx: %s", STRERR);
-		return -1;
-	}
-
-	/* prepare the forking */
-	if (UNLIKELY(posix_spawn_file_actions_init(&fa) < 0)) {
-		/* shit, what are we gonna do?*/
-		ECHS_ERR_LOG("cannot prepare forking to echsx: %s", STRERR);
-		return -1;
-	}
-
-	if (!(t->nsim < (unsigned int)t->t->max_simul - 1U)) {
-		args[2U] = "-nd";
-	}
-
-	/* prep the IPC with echsx */
-	posix_spawn_file_actions_adddup2(&fa, xin[0U], STDIN_FILENO);
-	posix_spawn_file_actions_addclose(&fa, xin[0U]);
-	posix_spawn_file_actions_addclose(&fa, xin[1U]);
-
-	/* get the journalling on the way */
-	if (snprintf(vjfn, sizeof(vjfn),
-			    "echsj_%u.ics", t->dflt_cred.u) < 0) {
-		/* couldn't care less */
-		vjfd = -1;
-	} else if ((vjfd = openat(qdirfd, vjfn, O_RDWR | O_CREAT, 0600)) < 0) {
-		/* brilliant */
-		;
-	} else if ((vjof = lseek(vjfd, 0, SEEK_END)) < 0) {
-		/* make sure we don't shed a tear over this one */
-		close(vjfd);
-		vjfd = -1;
-	} else {
-		/* all's well in either case */
-		posix_spawn_file_actions_adddup2(&fa, vjfd, STDOUT_FILENO);
-		posix_spawn_file_actions_addclose(&fa, vjfd);
-	}
-
-	/* finally fork out our child */
-	if (UNLIKELY(posix_spawn(&r, echsx, &fa, NULL, args, env) < 0)) {
-		ECHS_ERR_LOG("cannot fork: %s", STRERR);
-		r = -1;
-	}
-	/* free spawn resources */
-	posix_spawn_file_actions_destroy(&fa);
-
-	if (LIKELY(!(vjfd < 0))) {
-		close(vjfd);
-	}
-	/* close read side of the pipe to echsx(1) */
-	close(xin[0U]);
-
-	/* and splice our VTODO onto xin[1U] */
-	(void)vtodoify(xin[1U], t);
-	/* we're finished aren't we? */
-	close(xin[1U]);
-	return r;
-}
-
 static __attribute__((pure, const)) ev_tstamp
 instant_to_tstamp(echs_instant_t i)
 {
@@ -1256,6 +1385,9 @@ static echs_event_t
 unwind_till(echs_evstrm_t x, ev_tstamp t)
 {
 	echs_event_t e;
+
+	/* get close quickly, then do the rest one by one */
+	echs_evstrm_seek(x, epoch_to_echs_instant((time_t)t));
 	while (!echs_event_0_p(e = echs_evstrm_next(x)) &&
 	       instant_to_tstamp(e.from) < t) {
 		(void)echs_evstrm_pop(x);
@@ -1263,177 +1395,612 @@ unwind_till(echs_evstrm_t x, ev_tstamp t)
 	return e;
 }
 
-
-/* child pool */
-#define ECHS_CHLD_POOL_INIZ	(256U)
-static ev_child *free_chlds;
-static size_t nfree_chlds;
-static size_t zfree_chlds;
-
-/* pool list */
-struct clst_s {
-	ev_child *_1st;
-	size_t size;
-};
 
-static struct clst_s *cpools;
-static size_t ncpools;
-static size_t zcpools;
+/* lazy tasks, a task whose next run lies beyond the horizon drops its
+ * event stream and keeps nothing but its serialisation, the stream is
+ * rebuilt from that when the task comes within the horizon again */
+static ev_tstamp horizon;
+/* tasks are serialised through this pipe */
+static int dryfd[2U] = {-1, -1};
+/* only the VEVENT is kept, this is what goes around it */
+static const char dry_hdr[] = "BEGIN:VCALENDAR\nVERSION:2.0\n";
+static const char dry_ftr[] = "END:VCALENDAR\n";
+static char dry_buf[65536U];
 
-static ev_child*
-make_chld_pool(size_t n)
+static ssize_t
+dry_render(echs_instruc_t ins, _task_t t)
 {
-/* generate a pile of ev_childs and chain them up */
-	ev_child *res;
-
-	if (UNLIKELY((res = malloc(sizeof(*res) * n)) == NULL)) {
-		return NULL;
-	}
-	/* chain them up */
-	res[n - 1U].data = NULL;
-	for (size_t i = n - 1U; i > 0; i--) {
-		res[i - 1U].data = res + i;
-	}
-	/* also add res to the list of pools (for freeing them later) */
-	if (ncpools >= zcpools) {
-		const size_t nuz = (zcpools * 2U) ?: 16U;
-		void *nup = realloc(cpools, nuz * sizeof(*cpools));
+/* render a VCALENDAR with header INS and task T, unless NULL, into dry_buf
+ * by means of the dry pipe, return the number of bytes or -1 */
+	size_t bi = 0U;
 
-		if (UNLIKELY(nup == NULL)) {
-			/* I *KNEW* IT */
-			free(res);
-			return NULL;
+	if (UNLIKELY(dryfd[0U] < 0)) {
+		if (UNLIKELY(pipe(dryfd) < 0)) {
+			dryfd[0U] = dryfd[1U] = -1;
+			return -1;
 		}
-		/* surprise */
-		cpools = nup;
-		zcpools = nuz;
-	}
-	cpools[ncpools]._1st = res;
-	cpools[ncpools].size = n;
-	ncpools++;
-	return res;
-}
-
-static void
-free_chld_pools(void)
-{
-	if (cpools) {
-		for (size_t i = 0U; i < ncpools; i++) {
-			free(cpools[i]._1st);
+		for (size_t i = 0U; i < countof(dryfd); i++) {
+			(void)fd_cloexec(dryfd[i]);
+			(void)fcntl(dryfd[i], F_SETFL, O_NONBLOCK);
 		}
-		free(cpools);
 	}
-	cpools = NULL;
-	ncpools = zcpools = 0UL;
-	return;
-}
-
-static ev_child*
-make_chld(void)
-{
-/* create one child */
-	ev_child *res;
 
-	if (UNLIKELY(!nfree_chlds)) {
-		/* put some more ev_child objects into the pool */
-		const size_t adz = zfree_chlds ?: ECHS_CHLD_POOL_INIZ;
+	echs_icalify_init(dryfd[1U], ins);
+	if (t != NULL) {
+		echs_task_icalify(dryfd[1U], t->t);
+	}
+	echs_icalify_fini(dryfd[1U]);
 
-		free_chlds = make_chld_pool(adz);
-		if (UNLIKELY(free_chlds == NULL)) {
-			/* grrrr */
-			return NULL;
-		}
-		nfree_chlds = adz;
-		zfree_chlds = zfree_chlds ? adz * 2U : ECHS_CHLD_POOL_INIZ;
+	for (ssize_t nrd;
+	     bi < sizeof(dry_buf) &&
+		     (nrd = read(dryfd[0U], dry_buf + bi,
+				 sizeof(dry_buf) - bi)) > 0;
+	     bi += nrd);
+	if (UNLIKELY(bi >= sizeof(dry_buf) ||
+		     bi < strlenof(dry_ftr) ||
+		     memcmp(dry_buf + bi - strlenof(dry_ftr),
+			    dry_ftr, strlenof(dry_ftr)))) {
+		/* too big for the pipe, just drain it */
+		while (read(dryfd[0U], dry_buf, sizeof(dry_buf)) > 0);
+		return -1;
 	}
-	/* pop off the free list */
-	res = free_chlds;
-	free_chlds = free_chlds->data;
-	nfree_chlds--;
-	return res;
+	return bi;
 }
 
-static void
-free_chld(ev_child *c)
+static ssize_t
+dry_vevent(_task_t t, const char **vp)
 {
-/* hand chld C over to free list */
-	c->data = free_chlds;
-	free_chlds = c;
-	nfree_chlds++;
-	return;
-}
-
-
-/* checkpoint handling */
-typedef struct ndnd_s ndnd_t;
-
-struct ndnd_s {
-	NEDTRIE_ENTRY(ndnd_t) link;
-	uid_t key;
-	int fd;
-};
-
-NEDTRIE_HEAD(ndtr_t, ndnd_t);
-
-/* this one's quite limited, just 16 slots wide, but it's static and
- * instead of introducing complexity by managing this array we just
- * say that if all checkpoint slots have been used we make a complete
- * dump of every single user. */
-static ndtr_t chkpntr;
-static ndnd_t chkpnts[16U];
-static size_t ichkpnts;
+/* render wet task T and point VP to the VEVENT in dry_buf */
+	static const char bov[] = "BEGIN:VEVENT\n";
+	ssize_t bi;
 
-static inline uid_t
-ndnd_key(const ndnd_t *r)
-{
-	return r->key;
+	if (UNLIKELY((bi = dry_render(
+			      (echs_instruc_t){.v = INSVERB_SCHE}, t)) < 0)) {
+		return -1;
+	} else if (UNLIKELY((*vp = xmemmem(dry_buf, bi,
+					   bov, strlenof(bov))) == NULL)) {
+		/* nothing to render, finished task probably */
+		return -1;
+	}
+	/* strip the VCALENDAR bits */
+	return bi - strlenof(dry_ftr) - (*vp - dry_buf);
 }
 
-NEDTRIE_GENERATE(
-	static, ndtr_t, ndnd_t, link, ndnd_key, NEDTRIE_NOBBLEZEROS(ndtr_t));
-
-static inline void
-seen_init(ndtr_t *restrict x)
+static int
+dry_task(_task_t t)
 {
-	NEDTRIE_INIT(x);
-	return;
+/* drop T's event stream, serialise T first if that hasn't happened */
+	const char *vp;
+	ssize_t bi;
+
+	if (t->t->strm == NULL) {
+		/* dry already */
+		return 0;
+	} else if (t->dry != NULL) {
+		/* the rules don't change, so neither does the serialisation */
+		goto dry;
+	} else if (UNLIKELY((bi = dry_vevent(t, &vp)) < 0)) {
+		/* keep T as is */
+		return -1;
+	} else if (UNLIKELY((t->dry = malloc(bi)) == NULL)) {
+		return -1;
+	}
+	memcpy(t->dry, vp, t->ndry = bi);
+dry:
+	free_echs_evstrm(echs_task_rset_strm(t->t, NULL));
+	return 0;
 }
 
 static int
-seenp(ndtr_t *tr, uid_t u)
+wet_task(_task_t t)
 {
-	ndnd_t *tmp;
+/* rebuild T's event stream from its serialisation */
+	ical_parser_t pp = NULL;
+	echs_evstrm_t s = NULL;
+	size_t bi = 0U;
 
-	if ((tmp = NEDTRIE_FIND(ndtr_t, tr, &(ndnd_t){.key = u})) == NULL) {
+	if (t->t->strm != NULL) {
+		/* wet already */
+		return 0;
+	} else if (UNLIKELY(t->dry == NULL)) {
 		return -1;
 	}
-	return tmp->fd;
+	/* wrap it in a VCALENDAR again */
+	memcpy(dry_buf + bi, dry_hdr, strlenof(dry_hdr));
+	bi += strlenof(dry_hdr);
+	memcpy(dry_buf + bi, t->dry, t->ndry);
+	bi += t->ndry;
+	memcpy(dry_buf + bi, dry_ftr, strlenof(dry_ftr));
+	bi += strlenof(dry_ftr);
+	if (UNLIKELY(echs_evical_push(&pp, dry_buf, bi) < 0)) {
+		return -1;
+	}
+	for (echs_instruc_t ins;
+	     (ins = echs_evical_pull(&pp)).v == INSVERB_SCHE;) {
+		if (ins.t == NULL) {
+			continue;
+		} else if (s == NULL) {
+			/* steal the stream */
+			s = echs_task_rset_strm(ins.t, NULL);
+		}
+		free_echs_task(ins.t);
+	}
+	with (echs_instruc_t ins = echs_evical_last_pull(&pp)) {
+		if (ins.v == INSVERB_SCHE && ins.t != NULL) {
+			free_echs_task(ins.t);
+		}
+	}
+	if (UNLIKELY(s == NULL)) {
+		return -1;
+	}
+	(void)echs_task_rset_strm(t->t, s);
+	return 0;
 }
 
 static void
-add_seen(ndtr_t *tr, ndnd_t *nd)
+task_icalify(int whither, _task_t t)
 {
-	NEDTRIE_INSERT(ndtr_t, tr, nd);
+/* like echs_task_icalify() but T may be dry */
+	if (t->t->strm != NULL) {
+		echs_task_icalify(whither, t->t);
+	} else if (LIKELY(wet_task(t) >= 0)) {
+		/* only wet for the printing */
+		echs_task_icalify(whither, t->t);
+		(void)dry_task(t);
+	}
 	return;
 }
 
-static inline bool
-chkpntedp(uid_t u)
-{
-	if (NEDTRIE_FIND(ndtr_t, &chkpntr, &(ndnd_t){.key = u}) != NULL) {
-		return true;
-	}
-	return false;
-}
+
+/* queue journal, injects and ejects are appended to echsq.wal as they
+ * happen and the journal is replayed on top of the echsq_<uid>.ics
+ * snapshots at startup, the snapshots themselves are only rewritten
+ * once the journal grows too big or too old */
+#define ECHSD_WAL_MAXZ		(1048576U)
+#define ECHSD_WAL_MAXAGE	(3600)
+
+static const char walfn[] = "echsq.wal";
+static int walfd = -1;
+/* current size and time of first record */
+static size_t walz;
+static ev_tstamp walt;
+/* whether there's been appends since the last sync */
+static bool walsyncp;
 
 static void
-add_chkpnt(uid_t u)
+wal_reset(void)
 {
-	if (LIKELY(ichkpnts < countof(chkpnts))) {
-		const size_t i = ichkpnts++;
-		chkpnts[i].key = u;
-		NEDTRIE_INSERT(ndtr_t, &chkpntr, chkpnts + i);
+	if (walfd < 0 || !walz) {
+		return;
+	} else if (UNLIKELY(ftruncate(walfd, 0) < 0)) {
+		ECHS_ERR_LOG("cannot truncate queue journal: %s", STRERR);
+		return;
 	}
+	walz = 0U;
+	walt = 0;
+	return;
+}
+
+static void
+wal_cut(size_t o, ev_tstamp t)
+{
+/* drop the first O bytes of the journal, they are in the snapshots,
+ * the rest (written from time T onwards) goes into a fresh journal */
+	static const char tmpfn[] = ".echsq.wal";
+	const int fl = O_WRONLY | O_APPEND | O_CREAT | O_TRUNC;
+	char buf[65536U];
+	ssize_t nrd;
+	int ifd;
+	int ofd;
+
+	if (walfd < 0) {
+		return;
+	} else if (o >= walz) {
+		wal_reset();
+		return;
+	} else if ((ifd = openat(qdirfd, walfn, O_RDONLY)) < 0) {
+		goto err;
+	} else if ((ofd = openat(qdirfd, tmpfn, fl, 0600)) < 0) {
+		close(ifd);
+		goto err;
+	}
+	for (off_t io = o; (nrd = pread(ifd, buf, sizeof(buf), io)) > 0;
+	     io += nrd) {
+		if (write(ofd, buf, nrd) < nrd) {
+			nrd = -1;
+			break;
+		}
+	}
+	close(ifd);
+	if (nrd < 0 || fdatasync(ofd) < 0 ||
+	    renameat(qdirfd, tmpfn, qdirfd, walfn) < 0) {
+		close(ofd);
+		(void)unlinkat(qdirfd, tmpfn, 0);
+		goto err;
+	}
+	(void)fd_cloexec(ofd);
+	close(walfd);
+	walfd = ofd;
+	walz -= o;
+	walt = t;
+	return;
+
+err:
+	/* keep it all, replaying twice does no harm */
+	ECHS_ERR_LOG("cannot cut queue journal: %s", STRERR);
+	return;
+}
+
+static void add_chkpnt(uid_t u);
+
+static void
+wal_append(EV_P_ echs_toid_t oid)
+{
+/* journal the current state of task OID, i.e. either it's there
+ * and we record it in full, or it's gone and we record a cancel */
+	_task_t t;
+	off_t o;
+
+	if (walfd < 0) {
+		return;
+	} else if ((t = get_task(oid)) != NULL && !t->donep) {
+		echs_instruc_t ins = {INSVERB_SCHE, 0U, .t = t->t};
+
+		echs_icalify_init(walfd, ins);
+		task_icalify(walfd, t);
+		/* the owner's snapshot is out of date now */
+		add_chkpnt(echs_task_owner(t->t));
+	} else {
+		/* _eject_task1() has put the owner on the checkpoint list */
+		echs_icalify_init(walfd, (echs_instruc_t){.v = INSVERB_UNSC});
+		echs_unsc_icalify(walfd, obint_name(oid));
+	}
+	echs_icalify_fini(walfd);
+
+	if (LIKELY((o = lseek(walfd, 0, SEEK_END)) >= 0)) {
+		if ((size_t)o > walz) {
+			dstats.nwalb += o - walz;
+		}
+		walz = o;
+	}
+	if (walt <= 0) {
+		walt = ev_now(EV_A);
+	}
+	walsyncp = true;
+	return;
+}
+
+
+/* queue file signatures, we remember what every echsq_<uid>.ics looked
+ * like when we last read or wrote it, the whole file by mtime, size and
+ * hash, and every task in it by the hash of its component, on SIGHUP
+ * changed files are diffed against that and only the tasks whose
+ * components have changed are injected or ejected */
+struct tsig_s {
+	echs_toid_t oid;
+	hash_t h;
+};
+
+struct qsig_s {
+	time_t mt;
+	off_t sz;
+	/* when we read it, mtimes are too coarse to tell edits apart
+	 * that happen within a second of that */
+	time_t rt;
+	/* owner of the file */
+	uid_t ou;
+	/* hash of the file and of the calendar bits before the components */
+	hash_t h;
+	hash_t hh;
+	/* tasks, sorted by oid */
+	struct tsig_s *t;
+	size_t nt;
+	/* reload generation this file was last seen in */
+	unsigned int gen;
+};
+
+/* uid -> struct qsig_s*, keyed like ownr_ht */
+static oidmap_t qsig_ht;
+
+static int
+tsig_cmp(const void *x, const void *y)
+{
+	const struct tsig_s *a = x, *b = y;
+	return (a->oid > b->oid) - (a->oid < b->oid);
+}
+
+static int
+qfn(char *restrict buf, size_t bsz, uid_t u)
+{
+	return snprintf(buf, bsz, "echsq_%u.ics", u);
+}
+
+static char*
+qsig_slurp(struct qsig_s *restrict s, size_t *restrict bz,
+	   int dfd, const char *fn)
+{
+/* read FN in DFD in full, fill in the stat bits of S
+ * only regular files are read, and the owner is that of the file itself,
+ * the drop-in directory is anybody's, a FIFO would have us wait forever
+ * and a symlink would have us take on its target's owner, to callers
+ * such files look like they're not there at all */
+	const int fl = O_RDONLY | O_NONBLOCK | O_NOFOLLOW;
+	struct stat st;
+	char *buf;
+	int fd;
+
+	*bz = 0U;
+	s->rt = time(NULL);
+	if ((fd = openat(dfd, fn, fl)) < 0) {
+		if (errno == ELOOP) {
+			errno = ENOENT;
+		}
+		return NULL;
+	} else if (UNLIKELY(fstat(fd, &st) < 0)) {
+		goto clo;
+	} else if (UNLIKELY(!S_ISREG(st.st_mode))) {
+		errno = ENOENT;
+		goto clo;
+	} else if (UNLIKELY((buf = malloc(st.st_size + 1U)) == NULL)) {
+		goto clo;
+	}
+	for (ssize_t nrd;
+	     *bz < (size_t)st.st_size &&
+		     (nrd = read(fd, buf + *bz, st.st_size - *bz)) > 0;
+	     *bz += nrd);
+	close(fd);
+	s->mt = st.st_mtime;
+	s->sz = st.st_size;
+	s->ou = st.st_uid;
+	return buf;
+clo:
+	close(fd);
+	return NULL;
+}
+
+static void
+qsig_scan(struct qsig_s *restrict s, const char *buf, size_t bz)
+{
+/* sign the components in BUF by their UIDs */
+	const char *const ep = buf + bz;
+	const char *hp = NULL;
+	const char *cp = NULL;
+	echs_toid_t oid = 0U;
+	size_t zt = 0U;
+	int lvl = 0;
+
+	s->h = hash(buf, bz);
+	s->nt = 0U;
+	for (const char *bp = buf, *eol; bp < ep; bp = eol + 1U) {
+		size_t lz;
+
+		if ((eol = memchr(bp, '\n', ep - bp)) == NULL) {
+			eol = ep;
+		}
+		lz = eol - bp;
+		if (lz >= 6U && !memcmp(bp, "BEGIN:", 6U)) {
+			if (lvl++ == 1) {
+				/* component begins */
+				hp = hp ?: bp;
+				cp = bp;
+				oid = 0U;
+			}
+		} else if (lz >= 4U && !memcmp(bp, "END:", 4U)) {
+			if (--lvl != 1 || cp == NULL || !oid) {
+				continue;
+			} else if (s->nt >= zt) {
+				const size_t nuz = (zt * 2U) ?: 64U;
+				void *nup = realloc(s->t, nuz * sizeof(*s->t));
+
+				if (UNLIKELY(nup == NULL)) {
+					continue;
+				}
+				s->t = nup;
+				zt = nuz;
+			}
+			s->t[s->nt++] = (struct tsig_s){oid, hash(cp, eol - cp)};
+			cp = NULL;
+		} else if (lvl == 2 && lz > 4U && !memcmp(bp, "UID:", 4U)) {
+			lz -= bp[lz - 1U] == '\r';
+			oid = obint(bp + 4U, lz - 4U);
+		}
+	}
+	s->hh = hash(buf, (hp ?: ep) - buf);
+
+	/* sort, components sharing a UID make for one task */
+	qsort(s->t, s->nt, sizeof(*s->t), tsig_cmp);
+	with (size_t n = 0U) {
+		for (size_t i = 0U; i < s->nt; i++) {
+			if (n && s->t[n - 1U].oid == s->t[i].oid) {
+				s->t[n - 1U].h += s->t[i].h;
+			} else {
+				s->t[n++] = s->t[i];
+			}
+		}
+		s->nt = n;
+	}
+	return;
+}
+
+static struct qsig_s*
+get_qsig(uid_t u)
+{
+	struct qsig_s *s;
+
+	if (qsig_ht == NULL && UNLIKELY((qsig_ht = make_oidmap(64U)) == NULL)) {
+		return NULL;
+	} else if ((s = oidmap_get(qsig_ht, ownr_key(u))) != NULL) {
+		return s;
+	} else if (UNLIKELY((s = calloc(1U, sizeof(*s))) == NULL)) {
+		return NULL;
+	} else if (UNLIKELY(oidmap_put(qsig_ht, ownr_key(u), s) < 0)) {
+		free(s);
+		return NULL;
+	}
+	return s;
+}
+
+static void
+qsig_sign(uid_t u)
+{
+/* remember what echsq_U.ics looks like now */
+	char fn[PATH_MAX];
+	struct qsig_s *s;
+	char *buf;
+	size_t bz;
+
+	if (UNLIKELY((s = get_qsig(u)) == NULL)) {
+		return;
+	} else if (UNLIKELY(qfn(fn, sizeof(fn), u) < 0)) {
+		return;
+	} else if ((buf = qsig_slurp(s, &bz, qdirfd, fn)) == NULL) {
+		s->mt = 0;
+		s->sz = 0;
+		bz = 0U;
+	}
+	qsig_scan(s, buf ?: "", bz);
+	free(buf);
+	return;
+}
+
+static uid_t
+qfn_uid(const char *fn)
+{
+/* return the uid in FN if it's an echsq_<uid>.ics */
+	static const char prfx[] = "echsq_";
+	static const char sufx[] = ".ics";
+	unsigned long int u;
+	char *on;
+
+	if (strncmp(fn, prfx, strlenof(prfx))) {
+		return NOT_A_UID;
+	} else if ((u = strtoul(fn + strlenof(prfx), &on, 10)),
+		   on == fn + strlenof(prfx) || strcmp(on, sufx)) {
+		return NOT_A_UID;
+	}
+	return (uid_t)u;
+}
+
+static void
+qsig_sign_all(void)
+{
+	if_with (DIR *d, (d = fdopendir(dup(qdirfd))) != NULL) {
+		for (struct dirent *dp; (dp = readdir(d)) != NULL;) {
+			const uid_t u = qfn_uid(dp->d_name);
+
+			if (u != NOT_A_UID) {
+				qsig_sign(u);
+			}
+		}
+		closedir(d);
+	}
+	return;
+}
+
+static void
+qsig_resign(oidmap_t ht, bool allp)
+{
+/* snapshots of the users in HT (or everyone's) have been rewritten */
+	echs_oid_t k;
+
+	if (allp) {
+		qsig_sign_all();
+		return;
+	}
+	for (oidmap_iter_t i = 0U; ht != NULL && oidmap_next(&i, ht, &k);) {
+		qsig_sign(ownr_uid(k));
+	}
+	return;
+}
+
+static void
+free_qsigs(void)
+{
+	struct qsig_s *s;
+	echs_oid_t k;
+
+	for (oidmap_iter_t i = 0U;
+	     qsig_ht != NULL && (s = oidmap_next(&i, qsig_ht, &k));) {
+		free(s->t);
+		free(s);
+	}
+	free_oidmap(qsig_ht);
+	qsig_ht = NULL;
+	return;
+}
+
+/* checkpoint handling */
+typedef struct ndnd_s ndnd_t;
+
+struct ndnd_s {
+	NEDTRIE_ENTRY(ndnd_t) link;
+	uid_t key;
+	int fd;
+};
+
+NEDTRIE_HEAD(ndtr_t, ndnd_t);
+
+/* set of users whose snapshots are out of date, keyed like ownr_ht,
+ * should we fail to keep track we just dump every single user */
+static oidmap_t chkpnt_ht;
+static bool chkpnt_allp;
+static const char chkpnt_tag[] = "dirty";
+
+static inline uid_t
+ndnd_key(const ndnd_t *r)
+{
+	return r->key;
+}
+
+NEDTRIE_GENERATE(
+	static, ndtr_t, ndnd_t, link, ndnd_key, NEDTRIE_NOBBLEZEROS(ndtr_t));
+
+static inline void
+seen_init(ndtr_t *restrict x)
+{
+	NEDTRIE_INIT(x);
+	return;
+}
+
+static int
+seenp(ndtr_t *tr, uid_t u)
+{
+	ndnd_t *tmp;
+
+	if ((tmp = NEDTRIE_FIND(ndtr_t, tr, &(ndnd_t){.key = u})) == NULL) {
+		return -1;
+	}
+	return tmp->fd;
+}
+
+static void
+add_seen(ndtr_t *tr, ndnd_t *nd)
+{
+	NEDTRIE_INSERT(ndtr_t, tr, nd);
+	return;
+}
+
+static void
+add_chkpnt(uid_t u)
+{
+	if (chkpnt_allp) {
+		/* everyone's on the list */
+		;
+	} else if (UNLIKELY(chkpnt_ht == NULL) &&
+		   UNLIKELY((chkpnt_ht = make_oidmap(64U)) == NULL)) {
+		chkpnt_allp = true;
+	} else if (UNLIKELY(oidmap_put(chkpnt_ht, ownr_key(u),
+				       deconst(chkpnt_tag)) < 0)) {
+		chkpnt_allp = true;
+	}
+	return;
+}
+
+static void
+free_chkpnts(void)
+{
+	free_oidmap(chkpnt_ht);
+	chkpnt_ht = NULL;
 	return;
 }
 
@@ -1443,6 +2010,8 @@ chkpnt1(uid_t u)
 	char fn[PATH_MAX];
 	const int fl = O_WRONLY | O_CREAT | O_TRUNC;
 	bool inittedp = false;
+	_task_t t;
+	int syncd;
 	int fd;
 
 	if (UNLIKELY(snprintf(fn, sizeof(fn), ".echsq_%u.ics", u) < 0)) {
@@ -1451,27 +2020,31 @@ chkpnt1(uid_t u)
 		goto err;
 	}
 
-	for (size_t i = 0U; i < ztask_ht; i++) {
-		if (!task_ht[i].oid) {
-			continue;
-		} else if (echs_task_owner(task_ht[i].t->t) != u) {
+	for (t = ownr_tasks(u); t != NULL; t = t->onext) {
+		if (t->donep) {
 			continue;
 		} else if (!inittedp) {
 			echs_instruc_t ins = {
 				INSVERB_SCHE, 0U,
-				.t = task_ht[i].t->t,
+				.t = t->t,
 			};
 			echs_icalify_init(fd, ins);
 			inittedp = true;
 		}
 		/* let evical module handle the printing */
-		echs_task_icalify(fd, task_ht[i].t->t);
+		task_icalify(fd, t);
 	}
 	if (UNLIKELY(!inittedp)) {
 		echs_icalify_init(fd, (echs_instruc_t){INSVERB_UNK});
 	}
 	echs_icalify_fini(fd);
-	if (close(fd) < 0 || renameat(qdirfd, fn, qdirfd, fn + 1) < 0) {
+	with (off_t o = lseek(fd, 0, SEEK_CUR)) {
+		dstats.nsnapb += o > 0 ? o : 0;
+	}
+	/* the snapshot must be on disk before the journal goes */
+	syncd = fdatasync(fd);
+	if (close(fd) < 0 || syncd < 0 ||
+	    renameat(qdirfd, fn, qdirfd, fn + 1) < 0) {
 		int x = errno;
 		(void)unlinkat(qdirfd, fn, 0);
 		errno = x;
@@ -1494,7 +2067,8 @@ chkpnta(void)
 	ndtr_t sntr;
 	ndnd_t *snds;
 	size_t nsnds = 0UL;
-	size_t zsnds = countof(chkpnts);
+	size_t zsnds = 16U;
+	_task_t t;
 	int rc = 0;
 
 	if (UNLIKELY((snds = malloc(zsnds * sizeof(*snds))) == NULL)) {
@@ -1503,16 +2077,16 @@ chkpnta(void)
 	}
 
 	seen_init(&sntr);
-	for (size_t i = 0U; i < ztask_ht; i++) {
+	for (oidmap_iter_t i = 0U; (t = oidmap_next(&i, task_ht, NULL));) {
 		int fd;
 		uid_t u;
 
-		if (!task_ht[i].oid) {
-			continue;
-		} else if ((u = echs_task_owner(
-				    task_ht[i].t->t)) == NOT_A_UID) {
+		if ((u = echs_task_owner(t->t)) == NOT_A_UID) {
 			/* grml, no owner */
 			continue;
+		} else if (t->donep) {
+			/* cancelled, only waiting for its jobs */
+			continue;
 		} else if ((fd = seenp(&sntr, u)) >= 0) {
 			/* seen him */
 			;
@@ -1527,7 +2101,7 @@ chkpnta(void)
 		} else {
 			echs_instruc_t ins = {
 				INSVERB_SCHE, 0U,
-				.t = task_ht[i].t->t,
+				.t = t->t,
 			};
 
 			echs_icalify_init(fd, ins);
@@ -1554,11 +2128,12 @@ chkpnta(void)
 		}
 
 		/* let evical module handle the printing */
-		echs_task_icalify(fd, task_ht[i].t->t);
+		task_icalify(fd, t);
 	}
 	for (size_t i = 0U; i < nsnds; i++) {
 		const int fd = snds[i].fd;
 		const uid_t u = snds[i].key;
+		int syncd;
 
 		if (UNLIKELY(fd < -1)) {
 			/* just do them one by one here
@@ -1570,12 +2145,18 @@ chkpnta(void)
 			break;
 		}
 		echs_icalify_fini(fd);
+		with (off_t o = lseek(fd, 0, SEEK_CUR)) {
+			dstats.nsnapb += o > 0 ? o : 0;
+		}
 		if (snprintf(fn, sizeof(fn), ".echsq_%u.ics", u) < 0) {
 			/* oh fuck, there's really nothing we can do */
 			rc = -1;
 			continue;
 		}
-		if (close(fd) < 0 || renameat(qdirfd, fn, qdirfd, fn + 1) < 0) {
+		/* the snapshot must be on disk before the journal goes */
+		syncd = fdatasync(fd);
+		if (close(fd) < 0 || syncd < 0 ||
+		    renameat(qdirfd, fn, qdirfd, fn + 1) < 0) {
 			ECHS_ERR_LOG("\
 cannot checkpoint user %u's queue", u);
 			(void)unlinkat(qdirfd, fn, 0);
@@ -1585,51 +2166,258 @@ cannot checkpoint user %u's queue", u);
 checkpointed user %u", u);
 		}
 	}
+	/* users without any tasks left didn't show up above, empty
+	 * their snapshots or they'd come back to haunt us */
+	if_with (DIR *d, (d = fdopendir(dup(qdirfd))) != NULL) {
+		static const char prfx[] = "echsq_";
+		static const char sufx[] = ".ics";
+
+		for (struct dirent *dp; (dp = readdir(d)) != NULL;) {
+			const char *dn = dp->d_name;
+			char *on;
+			uid_t u;
+
+			if (strncmp(dn, prfx, strlenof(prfx))) {
+				continue;
+			}
+			u = strtoul(dn + strlenof(prfx), &on, 10);
+			if (on == dn + strlenof(prfx) || strcmp(on, sufx)) {
+				continue;
+			} else if (seenp(&sntr, u) != -1) {
+				continue;
+			}
+			rc += chkpnt1(u);
+		}
+		closedir(d);
+	}
 	free(snds);
 	return rc;
 }
 
 static int
-chkpnt(void)
+chkpnt_sync(void)
+{
+/* the snapshots' renames must be on disk, only then may the journal go */
+	if (UNLIKELY(fsync(qdirfd) < 0)) {
+		ECHS_ERR_LOG("cannot sync queue directory: %s", STRERR);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+chkpnt_dump(void)
 {
+/* write the snapshots of all users in the dirty set */
 	int rc = 0;
 
-	ECHS_NOTI_LOG("checkpoint");
-	if (ichkpnts >= countof(chkpnts)) {
+	if (UNLIKELY(chkpnt_allp)) {
 		rc = chkpnta();
-		goto fin;
+	} else if (chkpnt_ht != NULL) {
+		/* just go through the set of checkpoint users */
+		echs_oid_t k;
+
+		for (oidmap_iter_t i = 0U; oidmap_next(&i, chkpnt_ht, &k);) {
+			rc += chkpnt1(ownr_uid(k));
+		}
 	}
-	/* otherwise just go through the list of checkpoint users */
-	for (size_t i = 0U; i < ichkpnts; i++) {
-		rc += chkpnt1(chkpnts[i].key);
+	return rc + chkpnt_sync();
+}
+
+
+/* background checkpoints, the snapshots are written by a forked child
+ * off of its copy-on-write image of the task table while we carry on
+ * scheduling, there's at most one of these in flight */
+static bool chkpnt_bgp;
+
+static struct {
+	ev_child c;
+	/* the dirty set the child is working on */
+	oidmap_t ht;
+	bool allp;
+	/* journal size and time at the fork */
+	size_t walo;
+	ev_tstamp t;
+} bgcp;
+
+static void
+bgcp_done(EV_P_ int st)
+{
+	ev_child_stop(EV_A_ &bgcp.c);
+
+	if (WIFEXITED(st) && !WEXITSTATUS(st)) {
+		echs_oid_t k;
+
+		ECHS_NOTI_LOG("background checkpoint %d done", bgcp.c.pid);
+		/* the journal up to the fork is in the snapshots now */
+		wal_cut(bgcp.walo, bgcp.t);
+
+		dstats.nchkpnt++;
+		dstats.chkpnt_last = ev_now(EV_A) - bgcp.t;
+		dstats.chkpnt_total += dstats.chkpnt_last;
+		/* the child's byte count is lost, ask the file system */
+		for (oidmap_iter_t i = 0U;
+		     bgcp.ht != NULL && oidmap_next(&i, bgcp.ht, &k);) {
+			char fn[PATH_MAX];
+			struct stat sb;
+
+			if (snprintf(fn, sizeof(fn),
+				     "echsq_%u.ics", ownr_uid(k)) > 0 &&
+			    fstatat(qdirfd, fn, &sb, 0) >= 0) {
+				dstats.nsnapb += sb.st_size;
+			}
+		}
+		qsig_resign(bgcp.ht, bgcp.allp);
+	} else {
+		echs_oid_t k;
+
+		ECHS_ERR_LOG("background checkpoint %d failed: %d",
+			     bgcp.c.pid, st);
+		/* put them back on the list */
+		chkpnt_allp = chkpnt_allp || bgcp.allp;
+		for (oidmap_iter_t i = 0U;
+		     bgcp.ht != NULL && oidmap_next(&i, bgcp.ht, &k);) {
+			add_chkpnt(ownr_uid(k));
+		}
 	}
-fin:
-	/* all checkpoints cleared hopefully */
-	ichkpnts = 0U;
-	return rc;
+	free_oidmap(bgcp.ht);
+	bgcp.ht = NULL;
+	bgcp.c.pid = 0;
+	return;
 }
 
 static void
-cptim_cb(EV_P_ ev_timer *UNUSED(w), int UNUSED(revents))
+bgcp_cb(EV_P_ ev_child *c, int UNUSED(revents))
 {
-	chkpnt();
+	bgcp_done(EV_A_ c->rstatus);
 	return;
 }
 
-
-/* s2c communication */
-typedef enum {
-	ECHS_CMD_UNK,
-	ECHS_CMD_HTTP,
-	ECHS_CMD_ICAL,
-} echs_cmd_t;
+static void
+bgcp_wait(EV_P)
+{
+/* block until the background checkpoint is through */
+	int st;
 
-struct echs_cmd_http_s {
-	/* routine */
-	enum {
-		ECHS_HTTP_UNK,
-		ECHS_HTTP_QUEUE,
+	if (!bgcp.c.pid) {
+		return;
+	}
+	while (waitpid(bgcp.c.pid, &st, 0) < 0) {
+		if (errno != EINTR) {
+			/* someone else reaped him, assume the worst */
+			st = -1;
+			break;
+		}
+	}
+	bgcp_done(EV_A_ st);
+	return;
+}
+
+static int
+chkpnt(EV_P)
+{
+	ev_tstamp beg;
+	int rc;
+
+	/* don't trample on the child's files */
+	bgcp_wait(EV_A);
+
+	ECHS_NOTI_LOG("checkpoint");
+	beg = ev_time();
+	if (UNLIKELY((rc = chkpnt_dump()) < 0)) {
+		/* keep the set and the journal, we'll try again later */
+		return rc;
+	}
+	dstats.nchkpnt++;
+	dstats.chkpnt_last = ev_time() - beg;
+	dstats.chkpnt_total += dstats.chkpnt_last;
+	/* the snapshots we've written are no edits */
+	qsig_resign(chkpnt_ht, chkpnt_allp);
+	/* all checkpoints cleared */
+	if (chkpnt_ht != NULL) {
+		oidmap_clr(chkpnt_ht);
+	}
+	chkpnt_allp = false;
+	/* everything in the journal is in the snapshots now */
+	wal_reset();
+	return 0;
+}
+
+static int
+chkpnt_bg(EV_P)
+{
+	pid_t p;
+
+	if (bgcp.c.pid) {
+		/* one's still busy */
+		return 0;
+	} else if (!chkpnt_allp &&
+		   (chkpnt_ht == NULL || !oidmap_size(chkpnt_ht))) {
+		/* only the journal then */
+		wal_reset();
+		return 0;
+	}
+
+	switch ((p = fork())) {
+	case -1:
+		ECHS_ERR_LOG("\
+cannot fork background checkpoint, doing it here: %s", STRERR);
+		return chkpnt(EV_A);
+	case 0:
+		/* child, our signals are none of its business */
+		block_sigs();
+		_exit(chkpnt_dump() < 0);
+	default:
+		break;
+	}
+	ECHS_NOTI_LOG("background checkpoint %d", p);
+	/* the child takes care of the current set */
+	bgcp.ht = chkpnt_ht;
+	bgcp.allp = chkpnt_allp;
+	bgcp.walo = walz;
+	bgcp.t = ev_now(EV_A);
+	chkpnt_ht = NULL;
+	chkpnt_allp = false;
+
+	ev_child_init(&bgcp.c, bgcp_cb, p, false);
+	ev_child_start(EV_A_ &bgcp.c);
+	return 0;
+}
+
+static void
+cptim_cb(EV_P_ ev_timer *UNUSED(w), int UNUSED(revents))
+{
+	if (walsyncp) {
+		(void)fdatasync(walfd);
+		walsyncp = false;
+	}
+	if (walfd < 0 || walz >= ECHSD_WAL_MAXZ ||
+	    (walt > 0 && ev_now(EV_A) - walt >= ECHSD_WAL_MAXAGE)) {
+		/* compact the journal into the snapshots */
+		if (chkpnt_bgp) {
+			chkpnt_bg(EV_A);
+		} else {
+			chkpnt(EV_A);
+		}
+	}
+	return;
+}
+
+
+/* s2c communication */
+typedef enum {
+	ECHS_CMD_UNK,
+	ECHS_CMD_HTTP,
+	ECHS_CMD_ICAL,
+} echs_cmd_t;
+
+struct echs_cmd_http_s {
+	/* routine */
+	enum {
+		ECHS_HTTP_UNK,
+		ECHS_HTTP_QUEUE,
 		ECHS_HTTP_SCHED,
+		ECHS_HTTP_STATS,
 	} rou;
 	/* uid the user wants accessed */
 	uid_t uid;
@@ -1637,16 +2425,41 @@ struct echs_cmd_http_s {
 	size_t paramz;
 };
 
+/* bulk submissions are collected in full before anything is done */
+struct echs_bulk_s {
+	/* number of tasks announced */
+	size_t nann;
+	/* set if we couldn't keep track of everything */
+	bool badp;
+	size_t nins;
+	size_t zins;
+	echs_instruc_t *ins;
+	/* alongside INS, the user to run as, and the task object,
+	 * once checked */
+	struct bulk1_s {
+		uid_t u;
+		_task_t res;
+	} *x;
+};
+
 struct echs_cmdparam_s {
 	echs_cmd_t cmd;
 	union {
 		struct echs_cmd_http_s http;
 		ical_parser_t ical;
 	};
+	struct echs_bulk_s bulk;
 };
 
+static uid_t _check_task1(echs_task_t t, uid_t u);
+static void _bang_task1(EV_P_ _task_t res, echs_task_t t, ncred_t uc);
 static int _inject_task1(EV_P_ echs_task_t t, uid_t u);
+static int _check_eject1(echs_toid_t o, uid_t u);
 static int _eject_task1(EV_P_ echs_toid_t o, uid_t u);
+static void qsig_reload(EV_P);
+static void free_drp(EV_P);
+static void sched_rearm(EV_P);
+static void share_stats(void);
 
 static echs_cmd_t
 cmd_http_p(struct echs_cmdparam_s param[static 1U], const char *buf, size_t bsz)
@@ -1655,6 +2468,7 @@ cmd_http_p(struct echs_cmdparam_s param[static 1U], const char *buf, size_t bsz)
 	static const char ht_vers[] = " HTTP/1.1\r\n";
 	static const char sched[] = "sched";
 	static const char queue[] = "queue";
+	static const char stats[] = "stats";
 	const char *const eob = buf + bsz;
 	const char *bp;
 	const char *vp;
@@ -1694,6 +2508,9 @@ cmd_http_p(struct echs_cmdparam_s param[static 1U], const char *buf, size_t bsz)
 	} else if (!memcmp(bp, sched, strlenof(sched))) {
 		param->http.rou = ECHS_HTTP_SCHED;
 		bp += strlenof(sched);
+	} else if (!memcmp(bp, stats, strlenof(stats))) {
+		param->http.rou = ECHS_HTTP_STATS;
+		bp += strlenof(stats);
 	} else {
 		param->http.rou = ECHS_HTTP_UNK;
 	}
@@ -1736,6 +2553,194 @@ echs_http_send_sched(_task_t t, const char *tuid, size_t tusz)
 	return;
 }
 
+static void
+prom_head(const char *nm, const char *typ, const char *hlp)
+{
+	fdprintf("# HELP echsd_%s %s\n# TYPE echsd_%s %s\n", nm, hlp, nm, typ);
+	return;
+}
+
+static void
+prom_summ(const char *nm, const char *tuid, size_t tusz, const struct hist_s *h)
+{
+/* print H as summary NM, labelled with task TUID unless NULL */
+	/* in permille */
+	static const unsigned int qs[] = {500U, 900U, 990U, 999U, 1000U};
+	const int tuiz = tusz;
+
+	for (size_t i = 0U; i < countof(qs); i++) {
+		const double q = (double)qs[i] / 1000;
+		const double x = hist_secs(h, qs[i]);
+
+		if (tuid != NULL) {
+			fdprintf("echsd_%s{task=\"%.*s\",quantile=\"%g\"} %.6f\n",
+				 nm, tuiz, tuid, q, x);
+		} else {
+			fdprintf("echsd_%s{quantile=\"%g\"} %.6f\n",
+				 nm, q, x);
+		}
+	}
+	if (tuid != NULL) {
+		fdprintf("echsd_%s_sum{task=\"%.*s\"} %.6f\n",
+			 nm, tuiz, tuid, secs(h->sum));
+		fdprintf("echsd_%s_count{task=\"%.*s\"} %llu\n",
+			 nm, tuiz, tuid, (long long unsigned int)h->n);
+	} else {
+		fdprintf("echsd_%s_sum %.6f\n", nm, secs(h->sum));
+		fdprintf("echsd_%s_count %llu\n",
+			 nm, (long long unsigned int)h->n);
+	}
+	return;
+}
+
+static void
+echs_http_send_stats(void)
+{
+/* prometheus' text exposition format */
+	prom_head("tasks", "gauge", "Number of tasks.");
+	fdprintf("echsd_tasks %zu\n", oidmap_size(task_ht));
+	prom_head("task_pool_free", "gauge", "Task objects on the free list.");
+	fdprintf("echsd_task_pool_free %zu\n", nfree_tasks);
+	prom_head("task_pools", "gauge", "Task pools allocated.");
+	fdprintf("echsd_task_pools %zu\n", ntpools);
+	prom_head("connections", "gauge", "Open control socket connections.");
+	fdprintf("echsd_connections %zu\n", dstats.nconn);
+	prom_head("connection_deferrals_total", "counter",
+	     "Times accepting was paused for too many connections.");
+	fdprintf("echsd_connection_deferrals_total %zu\n", dstats.nconn_defer);
+
+	prom_head("spawns_total", "counter", "Jobs handed to echsx.");
+	fdprintf("echsd_spawns_total %zu\n", dstats.nspawn);
+	prom_head("spawn_failures_total", "counter",
+	     "Jobs that could not be handed to echsx.");
+	fdprintf("echsd_spawn_failures_total %zu\n", dstats.nspawnerr);
+	prom_head("skips_total", "counter",
+		  "Runs skipped for too many jobs in flight.");
+	fdprintf("echsd_skips_total %zu\n", dstats.nskip);
+	prom_head("running", "gauge", "Jobs in flight.");
+	fdprintf("echsd_running %zu\n", dstats.nrunning);
+	prom_head("queued", "gauge", "Runs waiting for the job budget.");
+	fdprintf("echsd_queued %zu\n", dstats.nqueued);
+	prom_head("queued_total", "counter",
+		  "Runs that had to wait for the job budget.");
+	fdprintf("echsd_queued_total %zu\n", dstats.nqueue);
+	prom_head("echsx_spawns_total", "counter", "echsx processes started.");
+	fdprintf("echsd_echsx_spawns_total %zu\n", dstats.nxwork);
+
+	prom_head("checkpoints_total", "counter", "Checkpoints taken.");
+	fdprintf("echsd_checkpoints_total %zu\n", dstats.nchkpnt);
+	prom_head("checkpoint_seconds", "gauge", "Duration of the last checkpoint.");
+	fdprintf("echsd_checkpoint_seconds %.6f\n", dstats.chkpnt_last);
+	prom_head("checkpoint_seconds_total", "counter",
+	     "Time spent checkpointing.");
+	fdprintf("echsd_checkpoint_seconds_total %.6f\n", dstats.chkpnt_total);
+
+	prom_head("written_bytes_total", "counter", "Bytes written to disk.");
+	fdprintf("echsd_written_bytes_total{file=\"journal\"} %zu\n",
+		 dstats.nwalb);
+	fdprintf("echsd_written_bytes_total{file=\"snapshot\"} %zu\n",
+		 dstats.nsnapb);
+
+	prom_head("wakeups_total", "counter", "Schedule timer expiries.");
+	fdprintf("echsd_wakeups_total %zu\n", dstats.nwake);
+	prom_head("wakeups_uncoalesced_total", "counter",
+		  "Schedule timer expiries there would have been without slack.");
+	fdprintf("echsd_wakeups_uncoalesced_total %zu\n", dstats.nwake_nom);
+	with (const double h = (ev_time() - dstats.beg) / 3600) {
+		prom_head("wakeups_per_hour", "gauge",
+			  "Schedule timer expiries per hour since start.");
+		fdprintf("echsd_wakeups_per_hour{coalesced=\"yes\"} %.1f\n",
+			 (double)dstats.nwake / h);
+		fdprintf("echsd_wakeups_per_hour{coalesced=\"no\"} %.1f\n",
+			 (double)dstats.nwake_nom / h);
+	}
+
+	prom_head("table_resizes_total", "counter", "Hash table resizes.");
+	fdprintf("echsd_table_resizes_total{table=\"tasks\"} %zu\n",
+		 oidmap_ngrow(task_ht));
+	fdprintf("echsd_table_resizes_total{table=\"owners\"} %zu\n",
+		 oidmap_ngrow(ownr_ht));
+	prom_head("fire_lag_seconds", "summary",
+		  "Delay between scheduled and actual start of jobs.");
+	prom_summ("fire_lag_seconds", NULL, 0U, &dstats.lag);
+	prom_head("serialise_seconds", "summary",
+		  "Time spent serialising jobs for echsx.");
+	prom_summ("serialise_seconds", NULL, 0U, &dstats.vtod);
+	prom_head("handover_seconds", "summary",
+		  "Time spent handing jobs over to echsx.");
+	prom_summ("handover_seconds", NULL, 0U, &dstats.spawn);
+	prom_head("run_seconds", "summary",
+		  "Time from hand-over until echsx reported back.");
+	prom_summ("run_seconds", NULL, 0U, &dstats.run);
+	prom_head("queue_wait_seconds", "summary",
+		  "Time runs spent waiting for the job budget.");
+	prom_summ("queue_wait_seconds", NULL, 0U, &dstats.qwait);
+	share_stats();
+	return;
+}
+
+static void
+echs_http_send_task_stats(const char *params, size_t paramz, uid_t u)
+{
+/* latencies of the tasks in PARAMS, samples of one metric have to go
+ * together so we go through the tasks once per metric */
+	static const char key[] = "tuid=";
+	static const struct {
+		const char *nm;
+		const char *hlp;
+		size_t off;
+	} ms[] = {
+		{"task_fire_lag_seconds",
+		 "Delay between scheduled and actual start of jobs.",
+		 offsetof(struct task_hist_s, lag)},
+		{"task_handover_seconds",
+		 "Time spent handing jobs over to echsx.",
+		 offsetof(struct task_hist_s, spawn)},
+		{"task_run_seconds",
+		 "Time from hand-over until echsx reported back.",
+		 offsetof(struct task_hist_s, run)},
+	};
+
+	for (size_t i = 0U; i < countof(ms); i++) {
+		prom_head(ms[i].nm, "summary", ms[i].hlp);
+		for (const char *pp = params, *const ep = params + paramz, *np;
+		     pp < ep; pp = np + 1U) {
+			echs_oid_t oid;
+			_task_t t;
+
+			np = memchr(pp, '&', ep - pp) ?: ep;
+			if (memcmp(pp, key, strlenof(key))) {
+				continue;
+			}
+			pp += strlenof(key);
+			if (!(oid = obint(pp, np - pp)) ||
+			    (t = get_task(oid)) == NULL ||
+			    !echs_task_owned_by_p(t->t, u) ||
+			    t->hist == NULL) {
+				/* nothing to report */
+				continue;
+			}
+			prom_summ(ms[i].nm, pp, np - pp,
+				  (const void*)((const char*)t->hist +
+						ms[i].off));
+		}
+	}
+	return;
+}
+
+static int
+http_user(
+	uid_t *restrict u, const struct echs_cmd_http_s cmd[static 1U], ncred_t c)
+{
+/* find the user whose data CMD may access on behalf of C, -1 if none */
+	if (UNLIKELY((*u = c.u & (unsigned)cmd->uid) != c.u)) {
+		return -1;
+	}
+	/* massage user */
+	*u = *u ?: cmd->uid;
+	return 0;
+}
+
 static ssize_t
 cmd_http(EV_P_ int ofd, const struct echs_cmd_http_s cmd[static 1U], ncred_t c)
 {
@@ -1750,40 +2755,25 @@ HTTP/1.1 200 Ok\r\n\r\n";
 	const char *rpl;
 	size_t rpz;
 	ssize_t nwr = 0;
-	int fd = -1;
-	size_t fz = 0U;
 	uid_t u;
 
-	if (UNLIKELY((u = c.u & (unsigned)cmd->uid) != c.u)) {
+	if (UNLIKELY(http_user(&u, cmd, c) < 0)) {
 		rpl = rpl403, rpz = strlenof(rpl403);
 		goto hdr;
 	}
-	/* massage user */
-	u = u ?: cmd->uid;
 
 	switch (cmd->rou) {
-		char fn[PATH_MAX];
-		struct stat st;
-
 	case ECHS_HTTP_QUEUE:
 		if (cmd->params && cmd->paramz) {
 			/* just go through stuff one by one, later on */
 			rpl = rpl200, rpz = strlenof(rpl200);
-		} else if (snprintf(fn, sizeof(fn), "echsq_%u.ics", u) < 0) {
-			rpl = rpl500, rpz = strlenof(rpl500);
-		} else if (chkpntedp(u) && chkpnt() < 0) {
-			rpl = rpl500, rpz = strlenof(rpl500);
-		} else if (fstatat(qdirfd, fn, &st, 0) < 0) {
-			ECHS_NOTI_LOG("can't find echsq_%u.ics", u);
-			rpl = rpl404, rpz = strlenof(rpl404);
-		} else if ((fd = openat(qdirfd, fn, O_RDONLY)) < 0) {
-			rpl = rpl403, rpz = strlenof(rpl403);
 		} else {
-			rpl = rpl200, rpz = strlenof(rpl200);
-			fz = st.st_size;
+			/* should have been streamed, see qstrm_init() */
+			rpl = rpl500, rpz = strlenof(rpl500);
 		}
 		break;
 	case ECHS_HTTP_SCHED:
+	case ECHS_HTTP_STATS:
 		rpl = rpl200, rpz = strlenof(rpl200);
 		break;
 	case ECHS_HTTP_UNK:
@@ -1795,19 +2785,14 @@ hdr:
 	/* write reply header */
 	nwr += write(ofd, rpl, rpz);
 
-	/* and now content, if any */
-	if (!(fd < 0)) {
-#if defined HAVE_SENDFILE
-		for (ssize_t nsf;
-		     fz && (nsf = sendfile(ofd, fd, NULL, fz)) > 0;
-		     fz -= nsf, nwr += nsf);
-#endif	/* HAVE_SENDFILE */
-		close(fd);
-	}
-
 	if (UNLIKELY(rpl != rpl200)) {
 		/* just do nothing */
 		;
+	} else if (cmd->rou == ECHS_HTTP_STATS && cmd->params && cmd->paramz) {
+		/* latencies of the tasks specified */
+		fdbang(ofd);
+		echs_http_send_task_stats(cmd->params, cmd->paramz, u);
+		fdflush();
 	} else if (cmd->rou && cmd->params && cmd->paramz) {
 		/* right, let's go through all tasks or the ones specified */
 		static const char key[] = "tuid=";
@@ -1851,7 +2836,7 @@ requesting task from user %d as user %d failed: permission denied", u, owner);
 
 			switch (cmd->rou) {
 			case ECHS_HTTP_QUEUE:
-				echs_task_icalify(ofd, t->t);
+				task_icalify(ofd, t);
 				break;
 
 			case ECHS_HTTP_SCHED:
@@ -1879,33 +2864,26 @@ requesting task from user %d as user %d failed: permission denied", u, owner);
 	} else if (cmd->rou) {
 		/* do something for all */
 		switch (cmd->rou) {
-		case ECHS_HTTP_QUEUE:
-			/* fingers crossed the checkpointed file
-			 * has been delivered via sendfile() above
-			 * i.e. not doing nothing here */
-			break;
-
 		case ECHS_HTTP_SCHED:
 			/* go through all the tasks */
 			fdbang(ofd);
-			for (size_t i = 0U; i < ztask_ht; i++) {
+			for (_task_t t = ownr_tasks(u); t != NULL; t = t->onext) {
 				const char *tu;
 				size_t tz;
 
-				if (!task_ht[i].oid) {
-					continue;
-				} else if (echs_task_owner(
-						   task_ht[i].t->t) != u) {
-					continue;
-				}
-				/* yep */
-				tu = obint_name(task_ht[i].oid);
+				tu = obint_name(t->t->oid);
 				tz = tu ? strlen(tu) : 0U;
-				echs_http_send_sched(task_ht[i].t, tu, tz);
+				echs_http_send_sched(t, tu, tz);
 			}
 			fdflush();
 			break;
 
+		case ECHS_HTTP_STATS:
+			fdbang(ofd);
+			echs_http_send_stats();
+			fdflush();
+			break;
+
 		default:
 			break;
 		}
@@ -1987,14 +2965,230 @@ REQUEST-STATUS:5.1;Service unavailable\n\
 }
 
 static ssize_t
-cmd_ical(EV_P_ int ofd, ical_parser_t cmd[static 1U], ncred_t cred)
+cmd_bulk_rpl(int ofd, bool succp, size_t n, echs_toid_t bad)
+{
+/* the one reply to a bulk submission of N tasks */
+	static const char rpl[] = "\
+BEGIN:VCALENDAR\n\
+METHOD:REPLY\n\
+BEGIN:VEVENT\n\
+ATTENDEE:echse\n\
+";
+	static const char ftr[] = "\
+END:VEVENT\n\
+END:VCALENDAR\n\
+";
+	char stmp[32U];
+	ssize_t nwr = 0;
+
+	dt_strf_ical(stmp, sizeof(stmp), epoch_to_echs_instant(time(NULL)));
+
+	fdbang(ofd);
+	nwr += fdwrite(rpl, strlenof(rpl));
+	if (bad) {
+		/* point the finger */
+		nwr += fdprintf("UID:%s\n", obint_name(bad));
+	}
+	nwr += fdprintf("DTSTAMP:%s\n", stmp);
+	if (succp) {
+		nwr += fdprintf("REQUEST-STATUS:2.0;Success;%zu\n", n);
+	} else {
+		nwr += fdprintf(
+			"REQUEST-STATUS:5.1;Service unavailable;%zu\n", n);
+	}
+	nwr += fdwrite(ftr, strlenof(ftr));
+	fdflush();
+	return nwr;
+}
+
+static void
+bulk_push(struct echs_bulk_s b[static 1U], echs_instruc_t ins)
+{
+	if (b->nins >= b->zins) {
+		const size_t nuz = (b->zins * 2U) ?: 64U;
+		void *nup = realloc(b->ins, nuz * sizeof(*b->ins));
+		void *nux = NULL;
+
+		if (LIKELY(nup != NULL)) {
+			b->ins = nup;
+			nux = realloc(b->x, nuz * sizeof(*b->x));
+		}
+		if (UNLIKELY(nux == NULL)) {
+			/* we'll have to turn the whole thing down */
+			if (ins.v == INSVERB_SCHE && ins.t != NULL) {
+				free_echs_task(ins.t);
+			}
+			b->badp = true;
+			return;
+		}
+		b->x = nux;
+		b->zins = nuz;
+	}
+	b->x[b->nins] = (struct bulk1_s){.u = NOT_A_UID};
+	b->ins[b->nins++] = ins;
+	return;
+}
+
+static void
+bulk_free(struct echs_bulk_s b[static 1U])
+{
+	for (size_t i = 0U; i < b->nins; i++) {
+		if (b->ins[i].v == INSVERB_SCHE && b->ins[i].t != NULL) {
+			free_echs_task(b->ins[i].t);
+		}
+	}
+	free(b->ins);
+	free(b->x);
+	memset(b, 0, sizeof(*b));
+	return;
+}
+
+static ssize_t
+cmd_bulk(EV_P_ int ofd, struct echs_bulk_s b[static 1U], ncred_t cred)
+{
+/* apply the bulk submission B in one go, or not at all */
+	echs_toid_t bad = 0U;
+	ssize_t nwr;
+	size_t i;
+
+	ECHS_NOTI_LOG("bulk submission of %zu tasks from %u", b->nins, cred.u);
+	/* we'll be asking for the same users over and over again */
+	make_pwcache();
+
+	if (UNLIKELY(b->badp)) {
+		ECHS_ERR_LOG("cannot keep track of bulk submission");
+		goto rej;
+	} else if (UNLIKELY(b->nins != b->nann)) {
+		ECHS_ERR_LOG("\
+bulk submission announced %zu tasks but has %zu", b->nann, b->nins);
+		goto rej;
+	}
+	/* check everything before touching anything */
+	for (i = 0U; i < b->nins; i++) {
+		echs_instruc_t *ins = b->ins + i;
+		struct bulk1_s *x = b->x + i;
+
+		switch (ins->v) {
+		case INSVERB_SCHE:
+			if (UNLIKELY(ins->t == NULL)) {
+				ECHS_ERR_LOG("\
+bulk submission has an unreadable task at position %zu", i);
+				goto rej;
+			}
+			bad = ins->t->oid;
+			x->u = _check_task1(ins->t, cred.u);
+			if (UNLIKELY(x->u == NOT_A_UID)) {
+				goto rej;
+			}
+			break;
+		case INSVERB_UNSC:
+			bad = ins->o;
+			if (UNLIKELY(_check_eject1(ins->o, cred.u) < 0)) {
+				goto rej;
+			}
+			break;
+		default:
+			goto rej;
+		}
+	}
+	/* a task cancelled and then scheduled again would be freed under
+	 * the object we're about to obtain for it, such cancels (and
+	 * repeated ones) are void, the schedule replaces the task anyway */
+	if (UNLIKELY(echs_evical_fold(b->ins, b->nins) == (size_t)-1)) {
+		ECHS_ERR_LOG("cannot fold bulk submission: %s", STRERR);
+		bad = 0U;
+		goto rej;
+	}
+	/* get hold of the task objects, that's the last thing that may fail,
+	 * repeated oids end up with the same object */
+	for (i = 0U; i < b->nins; i++) {
+		const echs_instruc_t *ins = b->ins + i;
+		struct bulk1_s *x = b->x + i;
+
+		if (ins->v != INSVERB_SCHE) {
+			continue;
+		} else if ((x->res = get_task(ins->t->oid)) != NULL) {
+			continue;
+		} else if (UNLIKELY((x->res = make_task(ins->t->oid)) == NULL)) {
+			ECHS_ERR_LOG("cannot submit new task");
+			bad = ins->t->oid;
+			goto unmk;
+		}
+	}
+	/* no way back now */
+	for (i = 0U; i < b->nins; i++) {
+		echs_instruc_t *ins = b->ins + i;
+		struct bulk1_s *x = b->x + i;
+
+		switch (ins->v) {
+		case INSVERB_SCHE:
+			ins->o = ins->t->oid;
+			_bang_task1(EV_A_ x->res, ins->t, compl_uid(x->u));
+			/* that's not ours anymore */
+			ins->t = NULL;
+			break;
+		case INSVERB_UNSC:
+			(void)_eject_task1(EV_A_ ins->o, cred.u);
+			break;
+		default:
+			/* folded */
+			continue;
+		}
+		wal_append(EV_A_ ins->o);
+	}
+	sched_rearm(EV_A);
+	add_chkpnt(cred.u);
+	nwr = cmd_bulk_rpl(ofd, true, b->nins, 0U);
+	goto out;
+
+unmk:
+	/* hand back the fresh objects, ... */
+	while (i-- > 0U) {
+		const echs_instruc_t *ins = b->ins + i;
+		struct bulk1_s *x = b->x + i;
+
+		if (ins->v != INSVERB_SCHE || x->res->t != NULL) {
+			/* ... not the ones that were there already */
+			continue;
+		} else if (get_task(ins->t->oid) != x->res) {
+			/* repeated oid, given back already */
+			continue;
+		}
+		unmake_task(x->res, ins->t->oid);
+	}
+rej:
+	ECHS_ERR_LOG("bulk submission of %zu tasks rejected", b->nins);
+	nwr = cmd_bulk_rpl(ofd, false, b->nins, bad);
+out:
+	free_pwcache();
+	bulk_free(b);
+	return nwr;
+}
+
+static ssize_t
+cmd_ical(EV_P_ int ofd, struct echs_cmdparam_s param[static 1U], ncred_t cred)
 {
+	ical_parser_t *cmd = &param->ical;
 	ssize_t nwr = 0;
 	bool need_dump_p = false;
 
 	do {
 		echs_instruc_t ins = echs_evical_pull(cmd);
 
+		if (!param->bulk.nann &&
+		    UNLIKELY((param->bulk.nann = echs_evical_bulk(cmd)))) {
+			ECHS_NOTI_LOG("\
+bulk submission of %zu tasks announced", param->bulk.nann);
+		}
+		if (param->bulk.nann) {
+			/* just collect them, they're dealt with at the end */
+			if (ins.v == INSVERB_UNK) {
+				goto fini;
+			}
+			bulk_push(&param->bulk, ins);
+			continue;
+		}
+
 		switch (ins.v) {
 		case INSVERB_SCHE:
 		case INSVERB_RESC:
@@ -2002,11 +3196,13 @@ cmd_ical(EV_P_ int ofd, ical_parser_t cmd[static 1U], ncred_t cred)
 				continue;
 			}
 			/* and otherwise inject him */
+			ins.o = ins.t->oid;
 			if (UNLIKELY(_inject_task1(EV_A_ ins.t, cred.u) < 0)) {
 				/* reply with REQUEST-STATUS:x */
 				ins.v = INSVERB_FAIL;
 				break;
 			}
+			wal_append(EV_A_ ins.o);
 			/* reply with REQUEST-STATUS:2.0;Success */
 			ins.v = INSVERB_SUCC;
 			break;
@@ -2019,6 +3215,7 @@ cmd_ical(EV_P_ int ofd, ical_parser_t cmd[static 1U], ncred_t cred)
 				ins.v = INSVERB_FAIL;
 				break;
 			}
+			wal_append(EV_A_ ins.o);
 			/* reply with REQUEST-STATUS:2.0;Success */
 			ins.v = INSVERB_SUCC;
 			break;
@@ -2037,6 +3234,10 @@ unknown instruction received from %d", ofd);
 		}
 	} while (1);
 fini:
+	if (param->bulk.nann && *cmd == NULL) {
+		/* the calendar is complete */
+		return cmd_bulk(EV_A_ ofd, &param->bulk, cred);
+	}
 	/* this flushes all replies */
 	cmd_ical_rpl_flush(ofd);
 	/* keep a note about checkpointing */
@@ -2076,6 +3277,8 @@ shut_cmd(struct echs_cmdparam_s param[static 1U])
 		break;
 
 	case ECHS_CMD_ICAL:
+		/* half-finished bulk submissions go, all of them */
+		bulk_free(&param->bulk);
 		if (LIKELY(param->ical == NULL)) {
 			break;
 		}
@@ -2102,11 +3305,11 @@ shut_cmd(struct echs_cmdparam_s param[static 1U])
 }
 
 
-/* libev conn handling */
-#define MAX_CONNS	(sizeof(free_conns) * 8U)
-#define MAX_QUEUE	MAX_CONNS
-typedef char echs_iobuf_t[4096U];
-static uint64_t free_conns = -1;
+/* libev conn handling, connections live in a table that grows on demand,
+ * if there's more than conn_max of them we stop accepting and leave the
+ * rest in the listen backlog until someone hangs up */
+#define CONN_BUF_MIN	(4096U)
+#define CONN_BUF_MAX	(256U * 1024U)
 static struct echs_conn_s {
 	ev_io r;
 	/* i/o buffer, its size and an offset */
@@ -2114,50 +3317,124 @@ static struct echs_conn_s {
 	size_t bsz;
 	off_t bix;
 
+	/* our slot in the conns table */
+	size_t slot;
+
 	/* socket credentials, established upon accepting() */
 	ncred_t cred;
 
 	/* the command we're building up
 	 * this contains a partial or full parse of all parameters */
 	struct echs_cmdparam_s cmd[1U];
-} conns[MAX_CONNS];
-static echs_iobuf_t bufs[MAX_CONNS];
+
+	/* queue listings are streamed, chunk by chunk, see qstrm_cb() */
+	ev_io w;
+	struct qstrm_s {
+		/* user whose queue we're listing, the oids still to go */
+		uid_t u;
+		echs_toid_t *oids;
+		size_t noids;
+		size_t ioids;
+		/* the chunk going out, and how much of it went already */
+		char *buf;
+		size_t bz;
+		size_t bi;
+		size_t bn;
+		/* set when the last chunk is in the buffer */
+		bool lastp;
+	} q;
+} **conns;
+static size_t nconns;
+static size_t zconns;
+static size_t conn_max = 256U;
+/* the listening socket's watcher, for the backpressure business */
+static ev_io *ctlw;
 
 static struct echs_conn_s*
 make_conn(void)
 {
-	int i = ffs(free_conns & 0xffffffffU)
-		?: ffs(free_conns >> 32U & 0xffffffffU);
+	struct echs_conn_s *res;
 
-	if (LIKELY(i-- > 0)) {
-		/* toggle bit in free conns */
-		free_conns ^= 1ULL << i;
+	if (UNLIKELY(nconns >= conn_max)) {
+		return NULL;
+	} else if (nconns >= zconns) {
+		const size_t nuz = (zconns * 2U) ?: 16U;
+		void *nup = realloc(conns, nuz * sizeof(*conns));
 
-		conns[i].buf = bufs[i];
-		conns[i].bsz = sizeof(bufs[i]);
-		conns[i].bix = 0;
-		return conns + i;
+		if (UNLIKELY(nup == NULL)) {
+			return NULL;
+		}
+		conns = nup;
+		zconns = nuz;
 	}
-	return NULL;
+	if (UNLIKELY((res = calloc(1, sizeof(*res))) == NULL)) {
+		return NULL;
+	} else if (UNLIKELY((res->buf = malloc(CONN_BUF_MIN)) == NULL)) {
+		free(res);
+		return NULL;
+	}
+	res->bsz = CONN_BUF_MIN;
+	res->slot = nconns;
+	conns[nconns++] = res;
+	dstats.nconn++;
+	return res;
 }
 
 static void
 free_conn(struct echs_conn_s *c)
 {
-	size_t i = c - conns;
+	const size_t i = c->slot;
 
-	if (UNLIKELY(i >= MAX_CONNS)) {
+	if (UNLIKELY(i >= nconns || conns[i] != c)) {
 		/* huh? */
 		ECHS_ERR_LOG("unknown connection passed to free_conn()");
 		return;
 	}
-	/* toggle C-th bit */
-	free_conns ^= 1ULL << i;
-	memset(c, 0, sizeof(*c));
+	/* plug the hole with the last one */
+	conns[i] = conns[--nconns];
+	conns[i]->slot = i;
+	free(c->q.oids);
+	free(c->q.buf);
+	free(c->buf);
+	free(c);
+	dstats.nconn--;
 	return;
 }
 
-
+static int
+grow_conn(struct echs_conn_s *c)
+{
+/* double C's buffer, there seems to be more coming than we can chew */
+	const size_t nuz = c->bsz * 2U;
+	void *nup;
+
+	if (c->bsz >= CONN_BUF_MAX) {
+		return -1;
+	} else if (UNLIKELY((nup = realloc(c->buf, nuz)) == NULL)) {
+		return -1;
+	}
+	c->buf = nup;
+	c->bsz = nuz;
+	return 0;
+}
+
+static void
+free_conns(void)
+{
+	for (size_t i = 0U; i < nconns; i++) {
+		close(conns[i]->r.fd);
+		free(conns[i]->q.oids);
+		free(conns[i]->q.buf);
+		free(conns[i]->buf);
+		free(conns[i]);
+	}
+	free(conns);
+	conns = NULL;
+	nconns = zconns = 0U;
+	return;
+}
+
+
 /* callbacks */
 static void
 sigint_cb(EV_P_ ev_signal *UNUSED(w), int UNUSED(revents))
@@ -2167,10 +3444,17 @@ sigint_cb(EV_P_ ev_signal *UNUSED(w), int UNUSED(revents))
 	return;
 }
 
+static void free_jfds(void);
+
 static void
 sighup_cb(EV_P_ ev_signal *UNUSED(w), int UNUSED(revents))
 {
-	ECHS_NOTI_LOG("SIGHUP caught, doing nothing");
+	ECHS_NOTI_LOG("SIGHUP caught, reloading queue files");
+	/* the child's snapshots aren't edits */
+	bgcp_wait(EV_A);
+	qsig_reload(EV_A);
+	/* journals might have been rotated, open them afresh */
+	free_jfds();
 	return;
 }
 
@@ -2182,429 +3466,2570 @@ sigpipe_cb(EV_P_ ev_signal *UNUSED(w), int UNUSED(revents))
 }
 
 static void
-unsched(EV_P_ ev_periodic *w, int UNUSED(revents))
+sigusr1_cb(EV_P_ ev_signal *UNUSED(w), int UNUSED(revents))
 {
-	_task_t t = (void*)w;
+/* log the latency figures */
+	static const struct {
+		const char *nm;
+		const struct hist_s *h;
+	} hs[] = {
+		{"fire lag", &dstats.lag},
+		{"serialise", &dstats.vtod},
+		{"hand-over", &dstats.spawn},
+		{"job run", &dstats.run},
+		{"queue wait", &dstats.qwait},
+	};
 
-	ECHS_NOTI_LOG("taking event off of schedule");
-	add_chkpnt(echs_task_owner(t->t));
-	ev_periodic_stop(EV_A_ w);
-	free_task(t);
+	for (size_t i = 0U; i < countof(hs); i++) {
+		const struct hist_s *h = hs[i].h;
+
+		ECHS_NOTI_LOG("\
+%s: n=%llu  p50=%.6fs  p90=%.6fs  p99=%.6fs  p999=%.6fs  max=%.6fs",
+			      hs[i].nm, (long long unsigned int)h->n,
+			      hist_secs(h, 500U), hist_secs(h, 900U),
+			      hist_secs(h, 990U), hist_secs(h, 999U),
+			      secs(h->max));
+	}
+	with (const double h = (ev_time() - dstats.beg) / 3600) {
+		ECHS_NOTI_LOG("wake-ups: %.1f/h  without slack: %.1f/h",
+			      (double)dstats.nwake / h,
+			      (double)dstats.nwake_nom / h);
+	}
 	return;
 }
 
-static void
-chld_cb(EV_P_ ev_child *c, int UNUSED(revents))
+/* the schedule, tasks sit on a timing wheel keyed by their next run
+ * and there's only one libev timer that fires when the wheel needs
+ * advancing, it's a periodic so it follows wall-clock jumps
+ * tasks with slack sit on the wheel keyed by the end of their window
+ * and on the lazy wheel keyed by its beginning, the lazy wheel has no
+ * timer, whatever's due there is run whenever the schedule goes off */
+static twheel_t sched;
+static twheel_t lazy;
+static ev_periodic schtim;
+
+static inline _task_t
+lazy_task(struct twnode_s *n)
 {
-	_task_t t = c->data;
+	return (_task_t)((char*)n - offsetof(struct _task_s, lw));
+}
 
-	ECHS_NOTI_LOG("chld %d coughed: %d", c->rpid, c->rstatus);
-	ev_child_stop(EV_A_ c);
-	c->rpid = c->pid = 0;
-	t->nsim--;
+static void
+sched_put(_task_t t, ev_tstamp soon)
+{
+/* put T on the schedule to run at SOON or within its slack */
+	const twtick_t tk = (twtick_t)soon;
+	twtick_t dl = tk + t->t->slack;
 
-	if (UNLIKELY(t->w.reschedule_cb == NULL)) {
-		/* we promised taskB_cb to kill this guy */
-		unsched(EV_A_ &t->w, 0);
+	if (!t->t->slack) {
+		twheel_add(sched, &t->w, tk);
+		return;
 	}
-	free_chld(c);
+	/* pick the tick with the most trailing zeroes in the window, so
+	 * deadlines of tasks with overlapping windows coincide */
+	for (twtick_t r; (r = dl & (dl - 1U)) >= tk; dl = r);
+	twheel_add(sched, &t->w, dl);
+	twheel_add(lazy, &t->lw, tk);
 	return;
 }
 
 static void
-task_cb(EV_P_ ev_periodic *w, int UNUSED(revents))
+sched_del(_task_t t)
 {
-/* B tasks always run under supervision of our event loop, should the task
- * be scheduled again while max_simul other tasks are still running, cancel
- * the execution and reschedule for the next time. */
-	_task_t t = (void*)w;
+	twheel_del(sched, &t->w);
+	twheel_del(lazy, &t->lw);
+	return;
+}
 
-	/* the task context holds the number of currently running children
-	 * as well as the maximum number of simultaneous children
-	 * if the maximum is running, defer the execution of this task */
-	if (t->nsim < (unsigned int)t->t->max_simul - 1U) {
-		pid_t p;
-
-		/* indicate that we might want to reuse the loop */
-		ev_loop_fork(EV_A);
-
-		if (LIKELY((p = run_task(t)) > 0)) {
-			ev_child *c = make_chld();
+static void
+unsched(EV_P_ _task_t t)
+{
+	ECHS_NOTI_LOG("taking event off of schedule");
+	add_chkpnt(echs_task_owner(t->t));
+	sched_del(t);
+	free_task(t);
+	return;
+}
 
-			/* consider us running already */
-			t->nsim++;
-			c->data = t;
+static void
+sched_rearm(EV_P)
+{
+/* make sure the schedule timer goes off when the wheel needs turning */
+	const twtick_t nx = twheel_timeout(sched);
+	ev_tstamp at;
 
-			/* keep track of the spawned child pid and register
-			 * a watcher for status changes */
-			ECHS_NOTI_LOG("supervising pid %d", p);
-			ev_child_init(c, chld_cb, p, false);
-			ev_child_start(EV_A_ c);
-		}
-	} else {
-		/* ooooh, we can't run, call run task with the warning
-		 * flag and use fire and forget */
-		(void)run_task(t);
+	if (nx == TWHEEL_NEVER) {
+		/* nothing to do, the timer may expire gracefully */
+		return;
 	}
-
-	/* prepare for rescheduling */
-	if (UNLIKELY(w->reschedule_cb == NULL)) {
-		/* the child watcher will reap this task */
-		;
+	at = (ev_tstamp)(twheel_now(sched) + nx);
+	if (ev_is_active(&schtim) && ev_periodic_at(&schtim) <= at) {
+		/* we'll be woken up early enough */
+		return;
 	}
+	ev_periodic_stop(EV_A_ &schtim);
+	ev_periodic_set(&schtim, at, 0, NULL);
+	ev_periodic_start(EV_A_ &schtim);
 	return;
 }
 
-static ev_tstamp
-resched(ev_periodic *w, ev_tstamp now)
+static int
+sched_task(EV_P_ _task_t t, ev_tstamp now)
 {
 /* the A queue doesn't wait for the jobs to finish, it is asynchronous
- * however jobs will only be timed AFTER NOW.
- * This will be called BEFORE the actual callback is called so we have
- * to defer unschedule operations by one. */
-	_task_t t = (void*)w;
+ * however jobs will only be timed AFTER NOW. */
 	echs_evstrm_t s = t->t->strm;
 	echs_event_t e = unwind_till(s, now);
 	ev_tstamp soon;
 	char stmp[32];
 
-	if (UNLIKELY(echs_event_0_p(e) && !t->nrun)) {
-		/* this has never been run in the first place */
-		ECHS_NOTI_LOG("event in the past, not scheduling");
-		w->reschedule_cb = NULL;
-		w->cb = unsched;
-		t->cur = echs_nul_instant();
-		return now;
-	} else if (UNLIKELY(echs_event_0_p(e))) {
-		/* we need to unschedule AFTER the next run */
-		ECHS_NOTI_LOG("event completed, will not reschedule");
-		w->reschedule_cb = NULL;
+	if (UNLIKELY(echs_event_0_p(e))) {
 		t->cur = echs_nul_instant();
-		return now + 1.e+30;
+		return -1;
 	}
 
-	/* store the current event range and calculate tstamp for libev */
+	/* store the current event range and put us on the wheel */
 	t->cur = e.from;
 	t->dur = e.dur;
 	soon = instant_to_tstamp(e.from);
 	t->nrun++;
+	if (horizon > 0 && soon - now > horizon && dry_task(t) >= 0) {
+		/* only wake up for it when it comes within the horizon */
+		twheel_add(sched, &t->w, (twtick_t)(soon - horizon));
+	} else {
+		sched_put(t, soon);
+	}
 
 	(void)dt_strf(stmp, sizeof(stmp), e.from);
 
 	ECHS_NOTI_LOG("next run %f (%s)", soon, stmp);
-	return soon;
+	return 0;
 }
 
 static void
-shut_conn(struct echs_conn_s *c)
+done_task(EV_P_ _task_t t)
 {
-/* shuts a connection partially or fully down */
-	const int fd = c->r.fd;
+/* one run of T has finished */
+	t->nsim--;
 
-	if (fd > 0) {
-		/* just shutdown all */
-		shutdown(fd, SHUT_RDWR);
+	if (UNLIKELY(t->donep && !t->nsim)) {
+		/* we promised task_cb to kill this guy */
+		unsched(EV_A_ t);
 	}
-	close(fd);
-	free_conn(c);
 	return;
 }
 
+
+/* job execution, rather than spawning an echsx per run we keep a few
+ * of them around in server mode and hand them job frames over a
+ * socketpair, they fork off the jobs and report back when done */
+#define NXWORKS		(2U)
+
+struct xwork_s {
+	ev_io r;
+	ev_child c;
+	/* jobs in flight, jid -> struct xrec_s* */
+	oidmap_t jobs;
+	/* frames echsx isn't ready for yet, in order, and their writer */
+	ev_io w;
+	struct xfrm_s *oq;
+	struct xfrm_s **oqt;
+};
+
+/* a job frame waiting to be sent, FD is our own copy */
+struct xfrm_s {
+	struct xfrm_s *next;
+	struct xjob_s j;
+	int fd;
+	size_t vtoz;
+	char vtod[];
+};
+
+/* what we remember about a job in flight */
+struct xrec_s {
+	_task_t t;
+	ev_tstamp beg;
+};
+
+static struct xwork_s xworks[NXWORKS];
+static uint32_t xjid;
+
+static void runq_drain(EV_P);
+
 static void
-sock_data_cb(EV_P_ ev_io *w, int UNUSED(revents))
+xwork_data_cb(EV_P_ ev_io *w, int UNUSED(revents))
 {
-	struct echs_conn_s *c = (void*)w;
-	const int fd = w->fd;
+	struct xwork_s *x = (void*)w;
+	struct xres_s r;
+	struct xrec_s *j;
 	ssize_t nrd;
 
-	/* just have a peek at what's there */
-	if (UNLIKELY((nrd = recv(fd, c->buf, c->bsz, 0)) < 0)) {
+	if (UNLIKELY((nrd = recv(w->fd, &r, sizeof(r), 0)) < 0)) {
+		if (errno == EINTR || errno == EAGAIN) {
+			return;
+		}
 		goto shut;
-	}
-	/* check the command we're supposed to obey */
-	switch (feed_cmd(c->cmd, c->buf, nrd)) {
-	case ECHS_CMD_HTTP:
-		(void)cmd_http(EV_A_ fd, &c->cmd->http, c->cred);
-		/* always shut him down */
+	} else if (UNLIKELY((size_t)nrd < sizeof(r))) {
+		/* hang-up or garbage, either way the child watcher
+		 * will do the cleaning up */
 		goto shut;
-
-	case ECHS_CMD_ICAL:
-		(void)cmd_ical(EV_A_ fd, &c->cmd->ical, c->cred);
-		if (UNLIKELY(nrd == 0)) {
-			goto shut;
+	} else if ((j = oidmap_del(x->jobs, r.jid)) == NULL) {
+		/* probably a no-run report */
+		return;
+	}
+	ECHS_NOTI_LOG("job %u coughed: %d  %ld.%06lis user  %ld.%06lis sys",
+		      r.jid, r.st,
+		      (long int)r.ru.ru_utime.tv_sec,
+		      (long int)r.ru.ru_utime.tv_usec,
+		      (long int)r.ru.ru_stime.tv_sec,
+		      (long int)r.ru.ru_stime.tv_usec);
+	with (const uint64_t d = usec(ev_time() - j->beg)) {
+		struct task_hist_s *h = task_hist(j->t);
+
+		hist_add(&dstats.run, d);
+		if (h != NULL) {
+			hist_add(&h->run, d);
 		}
-		break;
-
-	default:
-	case ECHS_CMD_UNK:
-		/* just shut him down */
-		ECHS_NOTI_LOG("unknown command");
-		goto shut;
 	}
+	dstats.nrunning--;
+	done_task(EV_A_ j->t);
+	free(j);
+	/* there's room for another one */
+	runq_drain(EV_A);
 	return;
 
 shut:
-	shut_cmd(c->cmd);
 	ev_io_stop(EV_A_ w);
-	ECHS_NOTI_LOG("freeing connection %d", w->fd);
-	shut_conn((struct echs_conn_s*)w);
 	return;
 }
 
-static void
-sock_conn_cb(EV_P_ ev_io *w, int UNUSED(revents))
+static bool
+xwork_lose(EV_P_ struct xwork_s *x, uint32_t jid)
 {
-	struct echs_conn_s *c;
-	struct sockaddr_un sa;
-	socklen_t z = sizeof(sa);
-	ncred_t cred;
-	int s;
+/* job JID won't be reported on, forget about it */
+	struct xrec_s *j;
 
-	if ((s = accept(w->fd, (struct sockaddr*)&sa, &z)) < 0) {
-		ECHS_ERR_LOG("connection vanished: %s", STRERR);
-		return;
-	} else if (UNLIKELY(set_peereuid(s) < 0) ||
-		   UNLIKELY(get_peereuid(&cred, s) < 0)) {
-		ECHS_ERR_LOG("\
-authenticity of connection %d cannot be established: %s", s, STRERR);
-		close(s);
-		return;
+	if ((j = oidmap_del(x->jobs, jid)) == NULL) {
+		/* no-run jobs aren't tracked */
+		return false;
 	}
+	dstats.nrunning--;
+	done_task(EV_A_ j->t);
+	free(j);
+	return true;
+}
 
-	/* very good, get us an io watcher */
-	ECHS_NOTI_LOG("connection %d from %u/%u", s, cred.u, cred.g);
-	if (UNLIKELY((c = make_conn()) == NULL)) {
-		ECHS_ERR_LOG("too many concurrent connections");
-		close(s);
-		return;
+static void
+free_xfrms(struct xwork_s *x)
+{
+	for (struct xfrm_s *f = x->oq, *nf; f != NULL; f = nf) {
+		nf = f->next;
+		if (f->fd >= 0) {
+			close(f->fd);
+		}
+		free(f);
 	}
-	/* pass on our findings about the connection credentials */
-	c->cred = cred;
+	x->oq = NULL;
+	x->oqt = &x->oq;
+	return;
+}
 
-	ev_io_init(&c->r, sock_data_cb, s, EV_READ);
-	ev_io_start(EV_A_ &c->r);
+static void
+xwork_wr_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+/* echsx is ready for more, send what's queued up */
+	struct xwork_s *x = w->data;
+	bool lostp = false;
+
+	for (struct xfrm_s *f; (f = x->oq) != NULL; free(f)) {
+		if (xjob_send(w->fd, f->j, f->vtod, f->vtoz, f->fd) < 0) {
+			if (errno == EINTR || errno == EAGAIN) {
+				return;
+			}
+			ECHS_ERR_LOG("\
+cannot hand job %u over to echsx: %s", f->j.jid, STRERR);
+			lostp |= xwork_lose(EV_A_ x, f->j.jid);
+		}
+		if ((x->oq = f->next) == NULL) {
+			x->oqt = &x->oq;
+		}
+		if (f->fd >= 0) {
+			close(f->fd);
+		}
+	}
+	ev_io_stop(EV_A_ w);
+	if (lostp) {
+		runq_drain(EV_A);
+	}
 	return;
 }
 
-
 static int
-daemonise(void)
+xwork_send(EV_P_ struct xwork_s *x,
+	   struct xjob_s j, const char *vtod, size_t vtoz, int fd)
 {
-	static char nulfn[] = "/dev/null";
-	int nulfd;
-	pid_t pid;
-	int rc = 0;
-
-	switch (pid = fork()) {
-	case -1:
-		return -1;
-	case 0:
-		/* i am the child */
-		break;
-	default:
-		/* i am the parent */
-		exit(0);
-	}
+/* send job J to echsx X, or queue it up if X's still busy reading,
+ * blocking here would deadlock with X blocking on its results */
+	struct xfrm_s *f;
 
-	if (UNLIKELY(setsid() < 0)) {
+	if (x->oq != NULL) {
+		/* others are before us */
+		;
+	} else if (xjob_send(x->r.fd, j, vtod, vtoz, fd) >= 0) {
+		return 0;
+	} else if (errno != EINTR && errno != EAGAIN) {
 		return -1;
 	}
-
-	if (UNLIKELY((nulfd = open(nulfn, O_RDONLY)) < 0)) {
-		/* nope, consider us fucked, we can't even print
-		 * the error message anymore */
+	if (UNLIKELY((f = malloc(sizeof(*f) + vtoz)) == NULL)) {
 		return -1;
-	} else if (UNLIKELY(dup2(nulfd, STDIN_FILENO) < 0)) {
-		/* yay, just what we need right now */
-		rc = -1;
 	}
-	/* make sure nobody sees what we've been doing */
-	close(nulfd);
-
-	if (UNLIKELY((nulfd = open(nulfn, O_WRONLY, 0600)) < 0)) {
-		/* bugger */
+	f->next = NULL;
+	f->j = j;
+	f->fd = -1;
+	f->vtoz = vtoz;
+	memcpy(f->vtod, vtod, vtoz);
+	/* the journal descriptor might be closed by the time it's sent */
+	if (fd < 0) {
+		;
+	} else if (UNLIKELY((f->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0)) < 0)) {
+		free(f);
 		return -1;
-	} else if (UNLIKELY(dup2(nulfd, STDOUT_FILENO) < 0)) {
-		/* nah, that's just not good enough */
-		rc = -1;
-	} else if (UNLIKELY(dup2(nulfd, STDERR_FILENO) < 0)) {
-		/* still shit */
-		rc = -1;
 	}
-	/* make sure we only have the copies around */
-	close(nulfd);
-	return rc;
+	*x->oqt = f;
+	x->oqt = &f->next;
+	ev_io_start(EV_A_ &x->w);
+	return 0;
 }
 
 static void
-echsd_run(const struct _echsd_s *ctx)
+xwork_chld_cb(EV_P_ ev_child *c, int UNUSED(revents))
 {
-	ECHS_NOTI_LOG("echsd ready");
-	ev_loop(ctx->loop, 0);
-	ECHS_NOTI_LOG("echsd exitting ...");
+	struct xwork_s *x = c->data;
+	struct xrec_s *j;
+	echs_oid_t jid;
+
+	ECHS_ERR_LOG("echsx %d vanished: %d", c->rpid, c->rstatus);
+	ev_child_stop(EV_A_ c);
+	ev_io_stop(EV_A_ &x->r);
+	ev_io_stop(EV_A_ &x->w);
+	close(x->r.fd);
+	free_xfrms(x);
+	/* its executors would go on running unaccounted for, they're in
+	 * echsx's process group, so are their jobs, take them all down */
+	(void)kill(-c->rpid, SIGKILL);
+
+	/* jobs still in flight won't ever be reported */
+	for (oidmap_iter_t i = 0U; (j = oidmap_next(&i, x->jobs, &jid));) {
+		dstats.nrunning--;
+		done_task(EV_A_ j->t);
+		free(j);
+	}
+	free_oidmap(x->jobs);
+	x->jobs = NULL;
+	runq_drain(EV_A);
 	return;
 }
 
-static struct _echsd_s*
-make_echsd(void)
+static int
+xwork_spawn(EV_P_ struct xwork_s *x)
 {
-	struct _echsd_s *res = calloc(1, sizeof(*res));
-	EV_P = ev_default_loop(EVFLAG_AUTO);
+	static char *args[] = {
+		"echsx",
+		/* job server mode */
+		"--daemon",
+		/* we want a vjournal log, defo defo */
+		"-v",
+		NULL
+	};
+	static char *env[] = {NULL};
+	posix_spawn_file_actions_t fa;
+	posix_spawnattr_t sa;
+	int sv[2U];
+	pid_t p;
+	int rc;
 
-	if (res == NULL) {
-	nul:
-		return NULL;
-	} else if (EV_A == NULL) {
-	fre:
-		free(res);
-		goto nul;
-	} else if (ini_task_ht() < 0) {
+	if (UNLIKELY(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) < 0)) {
+		ECHS_ERR_LOG("cannot set up socket to echsx: %s", STRERR);
+		return -1;
+	} else if (UNLIKELY((x->jobs = make_oidmap(64U)) == NULL)) {
+		ECHS_ERR_LOG("cannot set up job table: %s", STRERR);
+		goto clo;
+	} else if (UNLIKELY(posix_spawn_file_actions_init(&fa) < 0)) {
+		ECHS_ERR_LOG("cannot prepare forking to echsx: %s", STRERR);
+		goto fre;
+	} else if (UNLIKELY(posix_spawnattr_init(&sa) < 0)) {
+		ECHS_ERR_LOG("cannot prepare forking to echsx: %s", STRERR);
+		posix_spawn_file_actions_destroy(&fa);
 		goto fre;
 	}
+	/* our end mustn't leak into other children */
+	(void)fd_cloexec(sv[0U]);
+	/* neither end may block, see xwork_send() */
+	(void)fcntl(sv[0U], F_SETFL, O_NONBLOCK);
 
-	/* initialise private bits */
-	ev_signal_init(&res->sigint, sigint_cb, SIGINT);
-	ev_signal_start(EV_A_ &res->sigint);
-	ev_signal_init(&res->sighup, sighup_cb, SIGHUP);
-	ev_signal_start(EV_A_ &res->sighup);
-	ev_signal_init(&res->sigterm, sigint_cb, SIGTERM);
-	ev_signal_start(EV_A_ &res->sigterm);
-	ev_signal_init(&res->sigpipe, sigpipe_cb, SIGPIPE);
-	ev_signal_start(EV_A_ &res->sigpipe);
+	/* prep the IPC with echsx */
+	posix_spawn_file_actions_adddup2(&fa, sv[1U], STDIN_FILENO);
+	posix_spawn_file_actions_addclose(&fa, sv[1U]);
+	/* a process group of its own, for xwork_chld_cb() */
+	posix_spawnattr_setflags(&sa, POSIX_SPAWN_SETPGROUP);
+	posix_spawnattr_setpgroup(&sa, 0);
+
+	rc = posix_spawn(&p, echsx, &fa, &sa, args, env);
+	posix_spawnattr_destroy(&sa);
+	posix_spawn_file_actions_destroy(&fa);
+	if (UNLIKELY(rc)) {
+		errno = rc;
+		ECHS_ERR_LOG("cannot fork: %s", STRERR);
+		goto fre;
+	}
+	close(sv[1U]);
+
+	ECHS_NOTI_LOG("echsx %d ready for jobs", p);
+	dstats.nxwork++;
+	ev_io_init(&x->r, xwork_data_cb, sv[0U], EV_READ);
+	ev_io_start(EV_A_ &x->r);
+	ev_io_init(&x->w, xwork_wr_cb, sv[0U], EV_WRITE);
+	x->w.data = x;
+	x->oq = NULL;
+	x->oqt = &x->oq;
+	ev_child_init(&x->c, xwork_chld_cb, p, false);
+	x->c.data = x;
+	ev_child_start(EV_A_ &x->c);
+	return 0;
 
-	/* just do minutely checkpointing */
-	ev_timer_init(&res->cptim, cptim_cb, 60.0, 60.0);
-	ev_timer_start(EV_A_ &res->cptim);
+fre:
+	free_oidmap(x->jobs);
+	x->jobs = NULL;
+clo:
+	close(sv[0U]);
+	close(sv[1U]);
+	return -1;
+}
 
-	res->loop = EV_A;
+static struct xwork_s*
+xwork_pick(EV_P)
+{
+/* find the least busy echsx, start them up as needed */
+	struct xwork_s *res = NULL;
+
+	for (size_t i = 0U; i < countof(xworks); i++) {
+		struct xwork_s *x = xworks + i;
+
+		if (!ev_is_active(&x->c) && xwork_spawn(EV_A_ x) < 0) {
+			continue;
+		} else if (UNLIKELY(!ev_is_active(&x->r))) {
+			/* hung up on us, waiting to be reaped */
+			continue;
+		} else if (res == NULL ||
+			   oidmap_size(x->jobs) < oidmap_size(res->jobs)) {
+			res = x;
+		}
+	}
 	return res;
 }
 
 static void
-free_echsd(struct _echsd_s *ctx)
+free_xworks(void)
 {
-	/* final checkpointing */
-	chkpnt();
+/* hang up on all of them, they'll finish their jobs and leave */
+	for (size_t i = 0U; i < countof(xworks); i++) {
+		struct xwork_s *x = xworks + i;
+
+		if (x->jobs != NULL) {
+			struct xrec_s *j;
+
+			close(x->r.fd);
+			free_xfrms(x);
+			for (oidmap_iter_t k = 0U;
+			     (j = oidmap_next(&k, x->jobs, NULL));) {
+				free(j);
+			}
+			free_oidmap(x->jobs);
+			x->jobs = NULL;
+		}
+	}
+	return;
+}
+
+/* journal descriptors, one per user, opened for appending and handed
+ * to echsx with every job, when full the least recently used one goes
+ * records we write ourselves are batched up and written with one
+ * write() per journal in jfd_flush()
+ * once per wake-up a descriptor is checked against the journal's name
+ * so rotated journals are picked up, SIGHUP drops them all */
+#define NJFDS		(16U)
+
+static struct jfd_s {
+	uid_t u;
+	int fd;
+	unsigned int used;
+	/* wake-up we last checked FD in */
+	size_t chk;
+	char *buf;
+	size_t bi;
+	size_t bz;
+} jfds[NJFDS];
+static unsigned int jfd_clk;
+
+static void
+jfd_flush1(struct jfd_s *j)
+{
+	for (ssize_t nwr, twr = 0; (size_t)twr < j->bi; twr += nwr) {
+		/* the journal's O_APPEND, so this goes in in one piece */
+		nwr = write(j->fd, j->buf + twr, j->bi - twr);
+		if (UNLIKELY(nwr <= 0)) {
+			ECHS_ERR_LOG("\
+cannot write journal of user %u: %s", j->u, STRERR);
+			break;
+		}
+	}
+	j->bi = 0U;
+	return;
+}
+
+static void
+jfd_flush(void)
+{
+	for (size_t i = 0U; i < countof(jfds); i++) {
+		if (jfds[i].bi) {
+			jfd_flush1(jfds + i);
+		}
+	}
+	return;
+}
+
+static int
+jfd_open(uid_t u, struct stat *restrict st)
+{
+/* open U's journal, if ST is non-NULL see if it's still the file ST */
+	char fn[PATH_MAX];
+	int fd;
+
+	if (UNLIKELY(snprintf(fn, sizeof(fn), "echsj_%u.ics", u) < 0)) {
+		return -1;
+	} else if (st != NULL) {
+		struct stat cur;
+
+		if (fstatat(qdirfd, fn, &cur, 0) >= 0 &&
+		    cur.st_dev == st->st_dev && cur.st_ino == st->st_ino) {
+			/* still the same */
+			return -1;
+		}
+	}
+	if (UNLIKELY((fd = openat(qdirfd, fn,
+				  O_WRONLY | O_APPEND | O_CREAT, 0600)) < 0)) {
+		ECHS_ERR_LOG("cannot open journal %s: %s", fn, STRERR);
+		return -1;
+	}
+	/* echsx gets its own copy anyway */
+	(void)fd_cloexec(fd);
+	return fd;
+}
+
+static struct jfd_s*
+jfd_get(uid_t u)
+{
+	struct jfd_s *lru = jfds;
+	int fd;
+
+	for (size_t i = 0U; i < countof(jfds); i++) {
+		struct jfd_s *j = jfds + i;
+
+		if (j->used && j->u == u) {
+			struct stat st;
+
+			j->used = ++jfd_clk;
+			if (j->chk == dstats.nwake) {
+				/* checked already */
+				return j;
+			}
+			j->chk = dstats.nwake;
+			if (fstat(j->fd, &st) < 0 ||
+			    (fd = jfd_open(u, &st)) < 0) {
+				/* keep the old one */
+				return j;
+			}
+			/* journal's been rotated or removed, what's batched
+			 * up belongs to the old one still */
+			ECHS_NOTI_LOG("journal of user %u has moved", u);
+			jfd_flush1(j);
+			close(j->fd);
+			j->fd = fd;
+			return j;
+		} else if (j->used < lru->used) {
+			/* free slots have a use count of 0 */
+			lru = j;
+		}
+	}
+
+	if (UNLIKELY((fd = jfd_open(u, NULL)) < 0)) {
+		return NULL;
+	}
+	if (lru->used) {
+		jfd_flush1(lru);
+		close(lru->fd);
+	}
+	/* keep the buffer */
+	lru->u = u;
+	lru->fd = fd;
+	lru->used = ++jfd_clk;
+	lru->chk = dstats.nwake;
+	return lru;
+}
+
+static void
+free_jfds(void)
+{
+	for (size_t i = 0U; i < countof(jfds); i++) {
+		if (jfds[i].used) {
+			jfd_flush1(jfds + i);
+			close(jfds[i].fd);
+		}
+		free(jfds[i].buf);
+		jfds[i] = (struct jfd_s){0U};
+	}
+	return;
+}
+
+static int
+jfd_skip(_task_t t, ev_tstamp now)
+{
+/* put a record saying T has been skipped into its owner's journal
+ * batch, this is what echsx would write for a no-run job */
+	static const char desc[] = "\
+The scheduled task reached its maximum number of simultaneous runs.";
+	const char *tuid = obint_name(t->t->oid);
+	const char *cmd = t->t->cmd ?: "";
+	struct jfd_s *j;
+	char stmp[32U];
+	size_t need;
+	int z;
+
+	if (UNLIKELY((j = jfd_get(t->dflt_cred.u)) == NULL)) {
+		return -1;
+	}
+	need = 256U + strlen(tuid) + strlen(cmd) + strlenof(desc);
+	if (j->bi + need > j->bz) {
+		size_t nuz = (j->bz * 2U) ?: 4096U;
+		void *nup;
+
+		while (j->bi + need > nuz) {
+			nuz *= 2U;
+		}
+		if (UNLIKELY((nup = realloc(j->buf, nuz)) == NULL)) {
+			return -1;
+		}
+		j->buf = nup;
+		j->bz = nuz;
+	}
+	dt_strf_ical(stmp, sizeof(stmp), epoch_to_echs_instant((time_t)now));
+	z = snprintf(j->buf + j->bi, j->bz - j->bi, "\
+BEGIN:VTODO\n\
+DTSTAMP:%s\n\
+UID:%s\n\
+COMPLETED:%s\n\
+SUMMARY:%s\n\
+STATUS:CANCELLED\n\
+DESCRIPTION:%s\n\
+END:VTODO\n", stmp, tuid, stmp, cmd, desc);
+	if (UNLIKELY(z < 0 || (size_t)z >= j->bz - j->bi)) {
+		return -1;
+	}
+	j->bi += z;
+	return 0;
+}
+
+static int
+run_task(EV_P_ _task_t t, bool norun)
+{
+/* hand T over to one of the echsx's, if NORUN is set they will just
+ * report that the task couldn't be run */
+	struct xjob_s j = {
+		.flags = norun ? XJOB_NORUN : 0U,
+		.uid = t->dflt_cred.u,
+	};
+	const ev_tstamp beg = ev_time();
+	struct xwork_s *x;
+	struct xrec_s *xr;
+	int jfd;
+	int rc = 0;
+
+	if (UNLIKELY((x = xwork_pick(EV_A)) == NULL)) {
+		ECHS_ERR_LOG("no echsx to run jobs");
+		return -1;
+	} else if (UNLIKELY(vtodoify(t) < 0)) {
+		ECHS_ERR_LOG("cannot serialise task %s", obint_name(t->t->oid));
+		return -1;
+	}
+	hist_add(&dstats.vtod, usec(ev_time() - beg));
+	/* job ids are never 0 */
+	j.jid = ++xjid ?: ++xjid;
+
+	/* journal descriptor goes along, if we can't get one, so be it */
+	with (struct jfd_s *jf = jfd_get(t->dflt_cred.u)) {
+		jfd = jf != NULL ? jf->fd : -1;
+	}
+	if (UNLIKELY(xwork_send(EV_A_ x, j, vt_aux.buf, vt_aux.bi, jfd) < 0)) {
+		ECHS_ERR_LOG("cannot hand job over to echsx: %s", STRERR);
+		rc = -1;
+	} else if (norun) {
+		/* we're not interested in the outcome */
+		;
+	} else if (UNLIKELY((xr = malloc(sizeof(*xr))) == NULL)) {
+		ECHS_ERR_LOG("cannot keep track of job %u", j.jid);
+		rc = -1;
+	} else if (*xr = (struct xrec_s){t, ev_time()},
+		   UNLIKELY(oidmap_put(x->jobs, j.jid, xr) < 0)) {
+		ECHS_ERR_LOG("cannot keep track of job %u", j.jid);
+		free(xr);
+		rc = -1;
+	} else {
+		struct task_hist_s *h = task_hist(t);
+		const uint64_t d = usec(xr->beg - beg);
+
+		ECHS_NOTI_LOG("job %u handed to echsx %d", j.jid, x->c.pid);
+		hist_add(&dstats.spawn, d);
+		if (h != NULL) {
+			hist_add(&h->spawn, d);
+		}
+	}
+	return rc;
+}
+
+/* the run queue, when there's a budget of jobs in flight (RUN_MAX)
+ * runs beyond it wait here, as do runs of users over their rate limit
+ * every user has their own queue, highest priority first and first
+ * come first served otherwise, and users take turns by deficit
+ * round-robin according to their weights
+ * queued runs count towards their task's NSIM already */
+struct runq_s {
+	_task_t t;
+	int prio;
+	size_t seq;
+	ev_tstamp beg;
+};
+
+struct share_s {
+	uid_t u;
+	/* runs per turn */
+	unsigned int wght;
+	/* runs per second, 0 for no limit, and the token bucket */
+	double rate;
+	double tok;
+	ev_tstamp tokt;
+	/* runs left in the current turn */
+	unsigned int dfc;
+	/* queued runs, a heap */
+	struct runq_s *q;
+	size_t nq;
+	size_t zq;
+	/* next user with queued runs */
+	struct share_s *next;
+	/* runs handed out, runs queued and runs queued for the rate */
+	size_t nspawn;
+	size_t nqueue;
+	size_t nthrot;
+};
+
+static size_t run_max;
+static size_t runq_seq;
+/* uid -> struct share_s*, for configured users and those who queued */
+static oidmap_t share_ht;
+/* set if anyone's rate limited */
+static bool sharep;
+/* ring of users with queued runs, SHRQ->next is served next */
+static struct share_s *shrq;
+static size_t nshrq;
+/* for when everyone in the ring is over their rate */
+static ev_timer shrtim;
+
+static struct share_s*
+get_share(uid_t u)
+{
+	struct share_s *s;
+
+	if (share_ht == NULL && UNLIKELY((share_ht = make_oidmap(64U)) == NULL)) {
+		return NULL;
+	} else if ((s = oidmap_get(share_ht, ownr_key(u))) != NULL) {
+		return s;
+	} else if (UNLIKELY((s = calloc(1U, sizeof(*s))) == NULL)) {
+		return NULL;
+	}
+	s->u = u;
+	s->wght = 1U;
+	if (UNLIKELY(oidmap_put(share_ht, ownr_key(u), s) < 0)) {
+		free(s);
+		return NULL;
+	}
+	return s;
+}
+
+static int
+share_conf(const char *spec)
+{
+/* configure a user's share from USER:WEIGHT[:RATE] */
+	const char *on = strchr(spec, ':');
+	struct share_s *s;
+	char usr[64U];
+	uid_t u;
+	char *ep;
+
+	if (UNLIKELY(on == NULL || (size_t)(on - spec) >= sizeof(usr))) {
+		return -1;
+	}
+	xstrlncpy(usr, sizeof(usr), spec, on - spec);
+	if (u = strtoul(usr, &ep, 10), !*usr || *ep) {
+		/* not a uid, try the name */
+		u = compl_user(usr).u;
+	}
+	if (UNLIKELY(u == NOT_A_UID)) {
+		return -1;
+	} else if (UNLIKELY((s = get_share(u)) == NULL)) {
+		return -1;
+	} else if (UNLIKELY(!(s->wght = strtoul(on + 1U, &ep, 10)))) {
+		return -1;
+	} else if (*ep == ':' && (s->rate = strtod(ep + 1U, &ep)) < 0) {
+		return -1;
+	} else if (UNLIKELY(*ep)) {
+		return -1;
+	}
+	/* start out with a full bucket */
+	s->tok = s->rate < 1 ? 1 : s->rate;
+	sharep |= s->rate > 0;
+	return 0;
+}
+
+static bool
+share_take(struct share_s *s, ev_tstamp now)
+{
+/* take a token from S's bucket, return false if there's none */
+	if (s->rate <= 0) {
+		return true;
+	}
+	/* refill, buckets hold a second's worth but at least one token */
+	with (const double cap = s->rate < 1 ? 1 : s->rate) {
+		s->tok += (now - s->tokt) * s->rate;
+		s->tok = s->tok < cap ? s->tok : cap;
+		s->tokt = now;
+	}
+	if (s->tok < 1) {
+		return false;
+	}
+	s->tok -= 1;
+	return true;
+}
+
+static inline bool
+runq_before_p(const struct runq_s *a, const struct runq_s *b)
+{
+	return a->prio > b->prio || (a->prio == b->prio && a->seq < b->seq);
+}
+
+static void
+runq_down(struct share_s *s, size_t i, struct runq_s x)
+{
+/* put X into the hole at I of S's queue and let it sink */
+	for (size_t c; (c = 2U * i + 1U) < s->nq; i = c) {
+		if (c + 1U < s->nq && runq_before_p(s->q + c + 1U, s->q + c)) {
+			c++;
+		}
+		if (!runq_before_p(s->q + c, &x)) {
+			break;
+		}
+		s->q[i] = s->q[c];
+	}
+	s->q[i] = x;
+	return;
+}
+
+static int
+runq_push(struct share_s *s, _task_t t, ev_tstamp now)
+{
+	const struct runq_s x = {t, t->t->prio, runq_seq++, now};
+	size_t i;
+
+	if (UNLIKELY(s->nq >= s->zq)) {
+		const size_t nuz = (s->zq * 2U) ?: 64U;
+		void *nup;
+
+		if (UNLIKELY((nup = realloc(s->q, nuz * sizeof(*s->q))) == NULL)) {
+			return -1;
+		}
+		s->q = nup;
+		s->zq = nuz;
+	}
+	/* let it bubble up */
+	for (i = s->nq++; i > 0U; i = (i - 1U) / 2U) {
+		const size_t p = (i - 1U) / 2U;
+
+		if (!runq_before_p(&x, s->q + p)) {
+			break;
+		}
+		s->q[i] = s->q[p];
+	}
+	s->q[i] = x;
+	dstats.nqueued++;
+
+	if (s->nq == 1U) {
+		/* join the ring at the end of the round */
+		if (shrq == NULL) {
+			s->next = s;
+		} else {
+			s->next = shrq->next;
+			shrq->next = s;
+		}
+		shrq = s;
+		nshrq++;
+	}
+	return 0;
+}
+
+static void
+runq_unlink(struct share_s *s, struct share_s *prev)
+{
+/* take S, whose predecessor in the ring is PREV, out of the ring */
+	if (prev == s) {
+		shrq = NULL;
+	} else {
+		prev->next = s->next;
+		if (shrq == s) {
+			shrq = prev;
+		}
+	}
+	s->next = NULL;
+	s->dfc = 0U;
+	nshrq--;
+	return;
+}
+
+static struct runq_s
+runq_pop(struct share_s *s)
+{
+	const struct runq_s res = s->q[0U];
+
+	if (--s->nq) {
+		runq_down(s, 0U, s->q[s->nq]);
+	}
+	dstats.nqueued--;
+	return res;
+}
+
+static size_t
+runq_purge(_task_t t)
+{
+/* drop queued runs of T, return how many there were */
+	struct share_s *prev = shrq;
+	size_t res = 0U;
+
+	for (size_t k = nshrq; k; k--) {
+		struct share_s *s = prev->next;
+		size_t n = 0U;
+
+		for (size_t i = 0U; i < s->nq; i++) {
+			if (s->q[i].t != t) {
+				s->q[n++] = s->q[i];
+			}
+		}
+		if (n == s->nq) {
+			prev = s;
+			continue;
+		}
+		res += s->nq - n;
+		dstats.nqueued -= s->nq - n;
+		s->nq = n;
+		/* heapify what's left */
+		for (size_t i = s->nq / 2U; i-- > 0U;) {
+			runq_down(s, i, s->q[i]);
+		}
+		if (!s->nq) {
+			runq_unlink(s, prev);
+		} else {
+			prev = s;
+		}
+	}
+	return res;
+}
+
+static void
+runq_drain(EV_P)
+{
+/* hand out queued runs while the budget permits, users take turns
+ * handing out as many runs as they weigh, those over their rate are
+ * passed over and we come back when they've got tokens again */
+	const ev_tstamp now = ev_time();
+	double nap = 0;
+	size_t npass = 0U;
+
+	while (shrq != NULL && (!run_max || dstats.nrunning < run_max)) {
+		struct share_s *s = shrq->next;
+		struct runq_s q;
+
+		if (!s->dfc) {
+			/* S's turn */
+			s->dfc = s->wght;
+		}
+		if (!share_take(s, now)) {
+			const double w = (1 - s->tok) / s->rate;
+
+			nap = npass && nap < w ? nap : w;
+			s->dfc = 0U;
+			shrq = s;
+			if (++npass >= nshrq) {
+				break;
+			}
+			continue;
+		}
+		npass = 0U;
+		q = runq_pop(s);
+		hist_add(&dstats.qwait, usec(now - q.beg));
+		if (LIKELY(run_task(EV_A_ q.t, false) >= 0)) {
+			dstats.nrunning++;
+			dstats.nspawn++;
+			s->nspawn++;
+		} else {
+			dstats.nspawnerr++;
+			done_task(EV_A_ q.t);
+		}
+		if (!s->nq) {
+			runq_unlink(s, shrq);
+		} else if (!--s->dfc) {
+			/* next one's turn */
+			shrq = s;
+		}
+	}
+	if (npass && shrq != NULL) {
+		/* nobody's got tokens, come back when the first one does */
+		ev_timer_stop(EV_A_ &shrtim);
+		ev_timer_set(&shrtim, nap, 0);
+		ev_timer_start(EV_A_ &shrtim);
+	}
+	return;
+}
+
+static void
+shrtim_cb(EV_P_ ev_timer *UNUSED(w), int UNUSED(revents))
+{
+	runq_drain(EV_A);
+	return;
+}
+
+static int
+runq_admit(EV_P_ _task_t t)
+{
+/* see if a run of T may start right away, if not queue it up,
+ * return 1 if it may, 0 if it's been queued, -1 if neither */
+	const ev_tstamp now = ev_now(EV_A);
+	const bool roomp = !run_max || dstats.nrunning < run_max;
+	struct share_s *s;
+
+	if (!run_max && !sharep) {
+		/* no admission control */
+		return 1;
+	} else if (UNLIKELY((s = get_share(t->dflt_cred.u)) == NULL)) {
+		return -1;
+	} else if (roomp && !s->nq && share_take(s, now)) {
+		s->nspawn++;
+		return 1;
+	} else if (UNLIKELY(runq_push(s, t, now) < 0)) {
+		return -1;
+	}
+	s->nqueue++;
+	dstats.nqueue++;
+	if (roomp) {
+		/* it's the rate that's holding us back, and no job
+		 * will report back to get the queue going */
+		s->nthrot++;
+		runq_drain(EV_A);
+	}
+	return 0;
+}
+
+static void
+share_stats(void)
+{
+	struct share_s *s;
+	echs_oid_t k;
+
+	if (share_ht == NULL) {
+		return;
+	}
+	prom_head("user_spawns_total", "counter",
+		  "Jobs handed to echsx under admission control, per user.");
+	for (oidmap_iter_t i = 0U; (s = oidmap_next(&i, share_ht, &k));) {
+		fdprintf("echsd_user_spawns_total{uid=\"%u\"} %zu\n",
+			 s->u, s->nspawn);
+	}
+	prom_head("user_queued", "gauge", "Runs waiting, per user.");
+	for (oidmap_iter_t i = 0U; (s = oidmap_next(&i, share_ht, &k));) {
+		fdprintf("echsd_user_queued{uid=\"%u\"} %zu\n", s->u, s->nq);
+	}
+	prom_head("user_queued_total", "counter",
+		  "Runs that had to wait, per user.");
+	for (oidmap_iter_t i = 0U; (s = oidmap_next(&i, share_ht, &k));) {
+		fdprintf("echsd_user_queued_total{uid=\"%u\"} %zu\n",
+			 s->u, s->nqueue);
+	}
+	prom_head("user_throttled_total", "counter",
+		  "Runs that had to wait for the user's rate limit.");
+	for (oidmap_iter_t i = 0U; (s = oidmap_next(&i, share_ht, &k));) {
+		fdprintf("echsd_user_throttled_total{uid=\"%u\"} %zu\n",
+			 s->u, s->nthrot);
+	}
+	return;
+}
+
+static void
+free_runq(void)
+{
+	struct share_s *s;
+	echs_oid_t k;
+
+	if (share_ht == NULL) {
+		return;
+	}
+	for (oidmap_iter_t i = 0U; (s = oidmap_next(&i, share_ht, &k));) {
+		free(s->q);
+		free(s);
+	}
+	free_oidmap(share_ht);
+	share_ht = NULL;
+	shrq = NULL;
+	nshrq = 0U;
+	return;
+}
+
+static void
+task_cb(EV_P_ _task_t t)
+{
+/* B tasks always run under supervision of our event loop, should the task
+ * be scheduled again while max_simul other tasks are still running, cancel
+ * the execution and reschedule for the next time. */
+
+	/* the task context holds the number of currently running children
+	 * as well as the maximum number of simultaneous children
+	 * if the maximum is running, defer the execution of this task */
+	with (const uint64_t d = usec(ev_time() - instant_to_tstamp(t->cur))) {
+		struct task_hist_s *h = task_hist(t);
+
+		hist_add(&dstats.lag, d);
+		if (h != NULL) {
+			hist_add(&h->lag, d);
+		}
+	}
+	if (t->nsim < (unsigned int)t->t->max_simul - 1U) {
+		const int adm = runq_admit(EV_A_ t);
+
+		if (!adm) {
+			/* queued, consider us running already */
+			t->nsim++;
+		} else if (LIKELY(adm > 0 && run_task(EV_A_ t, false) >= 0)) {
+			/* consider us running already */
+			t->nsim++;
+			dstats.nrunning++;
+			dstats.nspawn++;
+		} else {
+			dstats.nspawnerr++;
+		}
+	} else if (t->t->org != NULL &&
+		   t->t->att != NULL && t->t->att->nl) {
+		/* ooooh, we can't run, they want mail about it though,
+		 * have echsx file a report and send it */
+		(void)run_task(EV_A_ t, true);
+	} else if (LIKELY(jfd_skip(t, ev_now(EV_A)) >= 0)) {
+		/* we can't run, the report goes out with the others */
+		dstats.nskip++;
+	}
+
+	/* prepare for rescheduling, the event we've just run is still
+	 * at the front of the stream */
+	(void)echs_evstrm_pop(t->t->strm);
+	if (UNLIKELY(sched_task(EV_A_ t, ev_now(EV_A)) < 0)) {
+		ECHS_NOTI_LOG("event completed, will not reschedule");
+		if (t->nsim) {
+			/* the job reports will reap this task */
+			t->donep = true;
+		} else {
+			unsched(EV_A_ t);
+		}
+	}
+	return;
+}
+
+/* nominal ticks of the runs so far, in ascending order, a tick can only
+ * come up again until the wheel has been turned past it, those before
+ * the current wake-up are pruned, what's left are the ticks of this
+ * wake-up and those of runs taken along early for their slack */
+static twtick_t *nomtks;
+static size_t nnomtks;
+static size_t znomtks;
+
+static bool
+sched_nom(twtick_t tk)
+{
+/* return true if nothing else was scheduled for tick TK, that is, we
+ * would have woken up for it if it weren't for slack */
+	size_t lo = 0U, hi = nnomtks;
+
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2U;
+
+		if (nomtks[mid] < tk) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo < nnomtks && nomtks[lo] == tk) {
+		return false;
+	} else if (UNLIKELY(nnomtks >= znomtks)) {
+		const size_t nuz = (znomtks * 2U) ?: 64U;
+		void *nup = realloc(nomtks, nuz * sizeof(*nomtks));
+
+		if (UNLIKELY(nup == NULL)) {
+			/* count it, we can't tell */
+			return true;
+		}
+		nomtks = nup;
+		znomtks = nuz;
+	}
+	memmove(nomtks + lo + 1U, nomtks + lo,
+		(nnomtks - lo) * sizeof(*nomtks));
+	nomtks[lo] = tk;
+	nnomtks++;
+	return true;
+}
+
+static void
+sched_nom_prune(twtick_t tk)
+{
+/* forget about nominal ticks before TK */
+	size_t n = 0U;
+
+	while (n < nnomtks && nomtks[n] < tk) {
+		n++;
+	}
+	memmove(nomtks, nomtks + n, (nnomtks - n) * sizeof(*nomtks));
+	nnomtks -= n;
+	return;
+}
+
+static void
+free_nomtks(void)
+{
+	free(nomtks);
+	nomtks = NULL;
+	nnomtks = znomtks = 0U;
+	return;
+}
+
+static void
+sched_run(EV_P_ _task_t t, ev_tstamp now)
+{
+	if (LIKELY(t->t->strm != NULL)) {
+		const ev_tstamp cur = instant_to_tstamp(t->cur);
+
+		dstats.nwake_nom += sched_nom((twtick_t)cur);
+		task_cb(EV_A_ t);
+		return;
+	}
+	/* dry tasks have no slack, their wake-up is our wake-up */
+	dstats.nwake_nom += sched_nom((twtick_t)now);
+	if (UNLIKELY(wet_task(t) < 0)) {
+		ECHS_ERR_LOG("\
+cannot rebuild task %s, cancelling", obint_name(t->t->oid));
+		unsched(EV_A_ t);
+	} else {
+		/* within the horizon now, put it up for the real run */
+		const ev_tstamp soon = instant_to_tstamp(t->cur);
+
+		(void)unwind_till(t->t->strm, now);
+		sched_put(t, soon);
+	}
+	return;
+}
+
+static void
+sched_cb(EV_P_ ev_periodic *UNUSED(w), int UNUSED(revents))
+{
+/* turn the wheel and run whatever has become due */
+	const ev_tstamp now = ev_now(EV_A);
+	size_t npop = 0U;
+
+	twheel_advance(sched, (twtick_t)now);
+	twheel_advance(lazy, (twtick_t)now);
+	for (struct twnode_s *n; (n = twheel_pop(sched)) != NULL;) {
+		_task_t t = (_task_t)n;
+
+		twheel_del(lazy, &t->lw);
+		sched_run(EV_A_ t, now);
+		npop++;
+	}
+	/* we're up anyway, take along what's within its slack */
+	for (struct twnode_s *n; (n = twheel_pop(lazy)) != NULL;) {
+		_task_t t = lazy_task(n);
+
+		twheel_del(sched, &t->w);
+		sched_run(EV_A_ t, now);
+		npop++;
+	}
+	/* skipped runs' records */
+	jfd_flush();
+	dstats.nwake++;
+	if (!npop) {
+		/* just turning the wheel, we'd have been woken up anyway */
+		dstats.nwake_nom += sched_nom((twtick_t)now);
+	}
+	/* everything up to now has been popped */
+	sched_nom_prune((twtick_t)now);
+	sched_rearm(EV_A);
+	return;
+}
+
+static void
+shut_conn(EV_P_ struct echs_conn_s *c)
+{
+/* shuts a connection partially or fully down */
+	const int fd = c->r.fd;
+
+	if (fd > 0) {
+		/* just shutdown all */
+		shutdown(fd, SHUT_RDWR);
+	}
+	close(fd);
+	free_conn(c);
+
+	if (ctlw != NULL && !ev_is_active(ctlw) && nconns < conn_max) {
+		/* there's room again, pick up where we left off */
+		ECHS_NOTI_LOG("accepting connections again");
+		ev_io_start(EV_A_ ctlw);
+	}
+	return;
+}
+
+/* chunks go out once they're this big */
+#define QSTRM_CHUNK	(16384U)
+/* room for the chunk size line in front of each chunk */
+#define QSTRM_CHDR	(16U)
+
+static int
+qstrm_put(struct qstrm_s q[static 1U], const char *s, size_t z)
+{
+/* append S of size Z to the current chunk */
+	if (UNLIKELY(q->bn + z + 8U > q->bz)) {
+		size_t nuz = q->bz;
+		void *nup;
+
+		while ((nuz *= 2U) < q->bn + z + 8U);
+		if (UNLIKELY((nup = realloc(q->buf, nuz)) == NULL)) {
+			return -1;
+		}
+		q->buf = nup;
+		q->bz = nuz;
+	}
+	memcpy(q->buf + q->bn, s, z);
+	q->bn += z;
+	return 0;
+}
+
+static void
+qstrm_fill(struct qstrm_s q[static 1U])
+{
+/* render the next chunk's worth of tasks */
+	static const char ftr[] = "END:VCALENDAR\n";
+	static const char eoc[] = "\r\n";
+	static const char lst[] = "0\r\n\r\n";
+	char chdr[QSTRM_CHDR];
+	size_t chz;
+
+	/* keep the buffer if it's there, we know it's empty */
+	q->bi = q->bn = QSTRM_CHDR;
+	while (q->bn - QSTRM_CHDR < QSTRM_CHUNK && q->ioids < q->noids) {
+		const echs_toid_t oid = q->oids[q->ioids++];
+		_task_t t = get_task(oid);
+		const char *vp;
+		ssize_t vz;
+
+		if (t == NULL || t->donep || !echs_task_owned_by_p(t->t, q->u)) {
+			/* gone since, or changed hands */
+			continue;
+		} else if (t->t->strm == NULL) {
+			/* dry tasks are as good as serialised */
+			vp = t->dry, vz = t->ndry;
+		} else if (UNLIKELY((vz = dry_vevent(t, &vp)) < 0)) {
+			continue;
+		}
+		if (UNLIKELY(qstrm_put(q, vp, vz) < 0)) {
+			ECHS_ERR_LOG("cannot list task 0x%x", oid);
+		}
+	}
+	if (q->ioids >= q->noids) {
+		/* that's the lot */
+		(void)qstrm_put(q, ftr, strlenof(ftr));
+		q->lastp = true;
+	}
+	/* frame it */
+	chz = snprintf(chdr, sizeof(chdr), "%zx\r\n", q->bn - QSTRM_CHDR);
+	q->bi -= chz;
+	memcpy(q->buf + q->bi, chdr, chz);
+	(void)qstrm_put(q, eoc, strlenof(eoc));
+	if (q->lastp) {
+		(void)qstrm_put(q, lst, strlenof(lst));
+	}
+	return;
+}
+
+static void
+qstrm_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+/* send what's pending, render another chunk when everything's gone */
+	struct echs_conn_s *c = w->data;
+	struct qstrm_s *q = &c->q;
+
+	if (q->bi >= q->bn) {
+		if (q->lastp) {
+			goto shut;
+		}
+		qstrm_fill(q);
+	}
+	for (ssize_t nwr; q->bi < q->bn; q->bi += nwr) {
+		if ((nwr = write(w->fd, q->buf + q->bi, q->bn - q->bi)) > 0) {
+			continue;
+		} else if (nwr < 0 && (errno == EAGAIN || errno == EINTR)) {
+			/* come back later */
+			return;
+		}
+		/* peer's gone */
+		goto shut;
+	}
+	return;
+
+shut:
+	ev_io_stop(EV_A_ w);
+	ECHS_NOTI_LOG("freeing connection %d", w->fd);
+	shut_conn(EV_A_ c);
+	return;
+}
+
+static int
+qstrm_init(EV_P_ struct echs_conn_s *c)
+{
+/* set up C to stream the queue listing, read watcher's stopped already */
+	static const char hdr[] = "\
+HTTP/1.1 200 Ok\r\n\
+Transfer-Encoding: chunked\r\n\r\n";
+	struct qstrm_s *q = &c->q;
+	echs_instruc_t ins = {INSVERB_UNK};
+	size_t zoids = 0U;
+	ssize_t hz;
+	uid_t u;
+
+	if (UNLIKELY(http_user(&u, &c->cmd->http, c->cred) < 0)) {
+		/* let cmd_http() do the telling off */
+		return -1;
+	}
+	/* the oids are all we keep, tasks may come and go in the meantime */
+	for (_task_t t = ownr_tasks(u); t != NULL; t = t->onext) {
+		if (t->donep) {
+			continue;
+		} else if (q->noids >= zoids) {
+			const size_t nuz = (zoids * 2U) ?: 256U;
+			void *nup = realloc(q->oids, nuz * sizeof(*q->oids));
+
+			if (UNLIKELY(nup == NULL)) {
+				goto fre;
+			}
+			q->oids = nup;
+			zoids = nuz;
+		}
+		if (ins.v == INSVERB_UNK) {
+			/* first task determines the defaults, like chkpnt1() */
+			ins = (echs_instruc_t){INSVERB_SCHE, 0U, .t = t->t};
+		}
+		q->oids[q->noids++] = t->t->oid;
+	}
+	q->u = u;
+
+	/* render the calendar header, cut off its footer */
+	if (UNLIKELY((hz = dry_render(ins, NULL)) < 0)) {
+		goto fre;
+	}
+	hz -= strlenof(dry_ftr);
+	q->bz = QSTRM_CHDR + QSTRM_CHUNK * 2U;
+	if (UNLIKELY((q->buf = malloc(q->bz)) == NULL)) {
+		goto fre;
+	}
+	/* the http header goes out on its own, then the calendar header
+	 * opens the first chunk */
+	memcpy(q->buf, hdr, q->bn = strlenof(hdr));
+	with (char chdr[QSTRM_CHDR]) {
+		size_t chz = snprintf(chdr, sizeof(chdr), "%zx\r\n", hz);
+
+		(void)qstrm_put(q, chdr, chz);
+		(void)qstrm_put(q, dry_buf, hz);
+		(void)qstrm_put(q, "\r\n", 2U);
+	}
+
+	(void)fcntl(c->r.fd, F_SETFL, O_NONBLOCK);
+	ev_io_init(&c->w, qstrm_cb, c->r.fd, EV_WRITE);
+	c->w.data = c;
+	ev_io_start(EV_A_ &c->w);
+	return 0;
+
+fre:
+	free(q->oids);
+	free(q->buf);
+	memset(q, 0, sizeof(*q));
+	return -1;
+}
+
+static void
+sock_data_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+	struct echs_conn_s *c = (void*)w;
+	const int fd = w->fd;
+	ssize_t nrd;
+
+	/* just have a peek at what's there */
+	if (UNLIKELY((nrd = recv(fd, c->buf, c->bsz, 0)) < 0)) {
+		goto shut;
+	}
+	/* check the command we're supposed to obey */
+	switch (feed_cmd(c->cmd, c->buf, nrd)) {
+	case ECHS_CMD_HTTP:
+		if (c->cmd->http.rou == ECHS_HTTP_QUEUE &&
+		    !(c->cmd->http.params && c->cmd->http.paramz)) {
+			/* no more reading, it's all writing from now on */
+			ev_io_stop(EV_A_ w);
+			if (qstrm_init(EV_A_ c) >= 0) {
+				return;
+			}
+		}
+		(void)cmd_http(EV_A_ fd, &c->cmd->http, c->cred);
+		/* always shut him down */
+		goto shut;
+
+	case ECHS_CMD_ICAL:
+		(void)cmd_ical(EV_A_ fd, c->cmd, c->cred);
+		if (UNLIKELY(nrd == 0)) {
+			goto shut;
+		}
+		break;
+
+	default:
+	case ECHS_CMD_UNK:
+		/* just shut him down */
+		ECHS_NOTI_LOG("unknown command");
+		goto shut;
+	}
+	if ((size_t)nrd == c->bsz) {
+		/* filled to the brim, big submission? read bigger chunks */
+		(void)grow_conn(c);
+	}
+	return;
+
+shut:
+	shut_cmd(c->cmd);
+	ev_io_stop(EV_A_ w);
+	ECHS_NOTI_LOG("freeing connection %d", w->fd);
+	shut_conn(EV_A_ (struct echs_conn_s*)w);
+	return;
+}
+
+static void
+sock_conn_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+	struct echs_conn_s *c;
+	struct sockaddr_un sa;
+	socklen_t z = sizeof(sa);
+	ncred_t cred;
+	int s;
+
+	if ((s = accept(w->fd, (struct sockaddr*)&sa, &z)) < 0) {
+		ECHS_ERR_LOG("connection vanished: %s", STRERR);
+		return;
+	} else if (UNLIKELY(set_peereuid(s) < 0) ||
+		   UNLIKELY(get_peereuid(&cred, s) < 0)) {
+		ECHS_ERR_LOG("\
+authenticity of connection %d cannot be established: %s", s, STRERR);
+		close(s);
+		return;
+	}
+
+	/* very good, get us an io watcher */
+	ECHS_NOTI_LOG("connection %d from %u/%u", s, cred.u, cred.g);
+	if (UNLIKELY((c = make_conn()) == NULL)) {
+		ECHS_ERR_LOG("cannot set up connection %d: %s", s, STRERR);
+		close(s);
+		return;
+	}
+	/* pass on our findings about the connection credentials */
+	c->cred = cred;
+
+	ev_io_init(&c->r, sock_data_cb, s, EV_READ);
+	ev_io_start(EV_A_ &c->r);
+
+	if (UNLIKELY(nconns >= conn_max)) {
+		/* that's it, let the kernel queue up the rest */
+		ECHS_NOTI_LOG("%zu connections, deferring new ones", nconns);
+		ctlw = w;
+		ev_io_stop(EV_A_ w);
+		dstats.nconn_defer++;
+	}
+	return;
+}
+
+
+static int
+daemonise(void)
+{
+	static char nulfn[] = "/dev/null";
+	int nulfd;
+	pid_t pid;
+	int rc = 0;
+
+	switch (pid = fork()) {
+	case -1:
+		return -1;
+	case 0:
+		/* i am the child */
+		break;
+	default:
+		/* i am the parent */
+		exit(0);
+	}
+
+	if (UNLIKELY(setsid() < 0)) {
+		return -1;
+	}
+
+	if (UNLIKELY((nulfd = open(nulfn, O_RDONLY)) < 0)) {
+		/* nope, consider us fucked, we can't even print
+		 * the error message anymore */
+		return -1;
+	} else if (UNLIKELY(dup2(nulfd, STDIN_FILENO) < 0)) {
+		/* yay, just what we need right now */
+		rc = -1;
+	}
+	/* make sure nobody sees what we've been doing */
+	close(nulfd);
+
+	if (UNLIKELY((nulfd = open(nulfn, O_WRONLY, 0600)) < 0)) {
+		/* bugger */
+		return -1;
+	} else if (UNLIKELY(dup2(nulfd, STDOUT_FILENO) < 0)) {
+		/* nah, that's just not good enough */
+		rc = -1;
+	} else if (UNLIKELY(dup2(nulfd, STDERR_FILENO) < 0)) {
+		/* still shit */
+		rc = -1;
+	}
+	/* make sure we only have the copies around */
+	close(nulfd);
+	return rc;
+}
+
+static void
+echsd_run(const struct _echsd_s *ctx)
+{
+	ECHS_NOTI_LOG("echsd ready");
+	ev_loop(ctx->loop, 0);
+	ECHS_NOTI_LOG("echsd exitting ...");
+	return;
+}
+
+static struct _echsd_s*
+make_echsd(void)
+{
+	struct _echsd_s *res = calloc(1, sizeof(*res));
+	EV_P = ev_default_loop(EVFLAG_AUTO);
+
+	if (res == NULL) {
+	nul:
+		return NULL;
+	} else if (EV_A == NULL) {
+	fre:
+		free(res);
+		goto nul;
+	} else if (ini_task_ht() < 0) {
+		goto fre;
+	} else if ((sched = make_twheel(0U)) == NULL) {
+		goto fre;
+	} else if ((lazy = make_twheel(0U)) == NULL) {
+		free_twheel(sched);
+		goto fre;
+	}
+	dstats.beg = ev_time();
+	/* the one timer to rule all tasks, the wheel starts at the epoch
+	 * and is turned to the present on its first expiry */
+	ev_periodic_init(&schtim, sched_cb, 0, 0, NULL);
+	ev_timer_init(&shrtim, shrtim_cb, 0, 0);
+
+	/* initialise private bits */
+	ev_signal_init(&res->sigint, sigint_cb, SIGINT);
+	ev_signal_start(EV_A_ &res->sigint);
+	ev_signal_init(&res->sighup, sighup_cb, SIGHUP);
+	ev_signal_start(EV_A_ &res->sighup);
+	ev_signal_init(&res->sigterm, sigint_cb, SIGTERM);
+	ev_signal_start(EV_A_ &res->sigterm);
+	ev_signal_init(&res->sigpipe, sigpipe_cb, SIGPIPE);
+	ev_signal_start(EV_A_ &res->sigpipe);
+	ev_signal_init(&res->sigusr1, sigusr1_cb, SIGUSR1);
+	ev_signal_start(EV_A_ &res->sigusr1);
+
+	/* just do minutely checkpointing */
+	ev_timer_init(&res->cptim, cptim_cb, 60.0, 60.0);
+	ev_timer_start(EV_A_ &res->cptim);
+
+	res->loop = EV_A;
+	return res;
+}
+
+static void
+free_echsd(struct _echsd_s *ctx)
+{
+	/* final checkpointing */
+	chkpnt(ctx != NULL ? ctx->loop : NULL);
+	free_chkpnts();
+	if (walfd >= 0) {
+		close(walfd);
+		walfd = -1;
+	}
+
+	if (UNLIKELY(ctx == NULL)) {
+		return;
+	}
+	if (LIKELY(ctx->loop != NULL)) {
+		free_drp(ctx->loop);
+		ev_break(ctx->loop, EVBREAK_ALL);
+		ev_loop_destroy(ctx->loop);
+	}
+	free_xworks();
+	free_runq();
+	free_jfds();
+	free_nomtks();
+	free_qsigs();
+	free_conns();
+	for (size_t i = 0U; i < countof(dryfd); i++) {
+		if (dryfd[i] >= 0) {
+			close(dryfd[i]);
+			dryfd[i] = -1;
+		}
+	}
+	free_task_pools();
+	free_task_ht();
+	free_twheel(sched);
+	free_twheel(lazy);
+	free(ctx);
+	return;
+}
+
+static uid_t
+_check_task1(echs_task_t t, uid_t u)
+{
+/* check if T can be injected on behalf of U, return the user T will be
+ * run as or NOT_A_UID if it can't be done, nothing is changed */
+	_task_t res;
+	ncred_t uc;
+	ncred_t oc;
+
+	/* massage owner and u
+	 * we allow U to be set to NOT_A_UID in which case the
+	 * uid will be taken from the compl'd T->owner slot */
+	oc = compl_owner(t->owner);
+	uc = compl_uid(u);
+
+	/* big checking */
+	if (uc.u == NOT_A_UID && oc.u == NOT_A_UID) {
+		/* can't have both unset, bugger off */
+		ECHS_ERR_LOG("\
+ignoring task update with no user nor owner specified");
+		return NOT_A_UID;
+	} else if (uc.u == NOT_A_UID && meself.uid && oc.u != meself.uid) {
+		ECHS_ERR_LOG("\
+need root privileges to run task as user %d", oc.u);
+		return NOT_A_UID;
+	} else if (oc.u == NOT_A_UID && meself.uid && uc.u != meself.uid) {
+		ECHS_ERR_LOG("\
+need root privileges to run task as user %d", uc.u);
+		return NOT_A_UID;
+	} else if (uc.u != NOT_A_UID && oc.u != NOT_A_UID && oc.u != uc.u) {
+		/* we've caught him, call the police!!! */
+		ECHS_ERR_LOG("\
+task update from user %d for task from user %d failed: permission denied",
+			     uc.u, oc.u);
+		return NOT_A_UID;
+	} else if (oc.u == NOT_A_UID && (oc.u = uc.u, false)) {
+		/* not reached */
+
+	} else if (uc.u == NOT_A_UID && (uc.u = oc.u, false)) {
+		/* not reached */
+
+	} else if (UNLIKELY(t->strm == NULL)) {
+		ECHS_ERR_LOG("submitted ical object is not a task");
+		return NOT_A_UID;
+	} else if ((res = get_task(t->oid)) != NULL &&
+		   !echs_task_owned_by_p(res->t, oc.u)) {
+		/* we've caught him, call the police!!! */
+		ECHS_ERR_LOG("\
+task update from user %d for task from user %d failed: permission denied",
+			     uc.u, echs_task_owner(res->t));
+		return NOT_A_UID;
+	} else if (UNLIKELY(compl_uid(uc.u).u == NOT_A_UID)) {
+		ECHS_ERR_LOG("user %u has vanished", oc.u);
+		return NOT_A_UID;
+	}
+	return uc.u;
+}
+
+static void
+_bang_task1(EV_P_ _task_t res, echs_task_t t, ncred_t uc)
+{
+/* put checked task T into RES, RES is either fresh or an old version of T,
+ * to be followed by a sched_rearm() */
+	bool newp;
+
+	if (res->t != NULL) {
+		ECHS_NOTI_LOG("task update, unscheduling old task");
+		sched_del(res);
+		res->donep = false;
+		free(deconst(res->dflt_cred.wd));
+		free(deconst(res->dflt_cred.sh));
+		free(res->dry);
+		res->dry = NULL;
+		free_echs_task(res->t);
+		res->t = NULL;
+		newp = false;
+	} else {
+		/* fresh tasks need to go into their owner's list */
+		newp = true;
+	}
+	/* massage away the owner in the task and
+	 * replace by the connection credentials */
+	echs_task_rset_ownr(t, uc.u);
+	/* bang libechse task into our _task */
+	res->t = t;
+	/* run all tasks as U and the default group of U */
+	res->dflt_cred.u = uc.u;
+	res->dflt_cred.g = uc.g;
+	/* also, by default, in U's home dir using U's shell */
+	res->dflt_cred.wd = strdup(uc.wd);
+	res->dflt_cred.sh = strdup(uc.sh);
+	if (newp && UNLIKELY(link_task(res) < 0)) {
+		ECHS_ERR_LOG("cannot index task for user %u", uc.u);
+	}
+
+	ECHS_NOTI_LOG("scheduling task for user %u(%u)", uc.u, uc.g);
+	if (UNLIKELY(sched_task(EV_A_ res, ev_now(EV_A)) < 0)) {
+		ECHS_NOTI_LOG("event in the past, not scheduling");
+		if (res->nsim) {
+			res->donep = true;
+		} else {
+			unsched(EV_A_ res);
+		}
+	}
+	return;
+}
+
+static int
+_inject_task1(EV_P_ echs_task_t t, uid_t u)
+{
+	_task_t res;
+	ncred_t uc;
+
+	if (UNLIKELY((u = _check_task1(t, u)) == NOT_A_UID)) {
+		return -1;
+	} else if (UNLIKELY((uc = compl_uid(u)).u == NOT_A_UID)) {
+		ECHS_ERR_LOG("user %u has vanished", u);
+		return -1;
+	} else if ((res = get_task(t->oid)) != NULL) {
+		/* task update */
+		;
+	} else if (UNLIKELY((res = make_task(t->oid)) == NULL)) {
+		ECHS_ERR_LOG("cannot submit new task");
+		return -1;
+	}
+	_bang_task1(EV_A_ res, t, uc);
+	sched_rearm(EV_A);
+	return 0;
+}
+
+static int
+_check_eject1(echs_toid_t oid, uid_t uid)
+{
+/* check if UID may cancel task OID */
+	_task_t res;
+
+	if (UNLIKELY((res = get_task(oid)) == NULL)) {
+		ECHS_ERR_LOG("\
+cannot update task: no task with oid 0x%x found", oid);
+		return -1;
+	} else if (UNLIKELY(!echs_task_owned_by_p(res->t, uid))) {
+		/* we've caught him, call the police!!! */
+		ECHS_ERR_LOG("\
+task update from user %d for task from user %d failed: permission denied",
+			     uid, echs_task_owner(res->t));
+		return -1;
+	}
+	return 0;
+}
+
+static int
+_eject_task1(EV_P_ echs_toid_t oid, uid_t uid)
+{
+	_task_t res;
+
+	if (UNLIKELY(_check_eject1(oid, uid) < 0)) {
+		return -1;
+	}
+	/* otherwise proceed with the evacuation */
+	res = get_task(oid);
+	ECHS_NOTI_LOG("cancelling task 0x%x", oid);
+	/* the owner's snapshot still has him, and the journalled cancel
+	 * goes with the next checkpoint of whoever, so rewrite it */
+	add_chkpnt(echs_task_owner(res->t));
+	sched_del(res);
+	/* runs that haven't started yet won't */
+	res->nsim -= runq_purge(res);
+	if (res->nsim) {
+		/* there's jobs in flight, the job reports will reap him */
+		res->donep = true;
+		return 0;
+	}
+	free_task(res);
+	return 0;
+}
+
+static void
+_inject_pull(EV_P_ ical_parser_t *pp)
+{
+/* pull all instructions the parser has ready and act on them */
+	do {
+		echs_instruc_t ins = echs_evical_pull(pp);
+
+		if (ins.v == INSVERB_UNSC) {
+			/* only the journal has these, we trust it */
+			_task_t t = get_task(ins.o);
+
+			if (t != NULL) {
+				_eject_task1(EV_A_ ins.o,
+					     echs_task_owner(t->t));
+			}
+			continue;
+		} else if (UNLIKELY(ins.v != INSVERB_SCHE)) {
+			break;
+		} else if (UNLIKELY(ins.t == NULL)) {
+			continue;
+		} else if (UNLIKELY(!ins.t->oid)) {
+			/* not even an OID */
+			free_echs_task(ins.t);
+			continue;
+		}
+		/* and otherwise inject him */
+		_inject_task1(EV_A_ ins.t, NOT_A_UID);
+	} while (1);
+	return;
+}
+
+static void
+_inject_last(ical_parser_t *pp)
+{
+	/* last ever pull this morning */
+	echs_instruc_t ins = echs_evical_last_pull(pp);
+
+	if (UNLIKELY(ins.v != INSVERB_SCHE)) {
+		;
+	} else if (UNLIKELY(ins.t != NULL)) {
+		/* that can't be right, we should have got
+		 * the last task in the loop above, this means
+		 * this is a half-finished thing and we don't
+		 * want no half-finished things */
+		free_echs_task(ins.t);
+	}
+	return;
+}
+
+static bool
+_reload_task1(EV_P_ echs_task_t t, uid_t u,
+	      const struct tsig_s *chg, size_t nchg)
+{
+/* inject T on behalf of U if it's among the changed tasks CHG,
+ * free it otherwise */
+	const struct tsig_s k = {.oid = t != NULL ? t->oid : 0U};
+	const echs_toid_t oid = k.oid;
+
+	if (t == NULL) {
+		return false;
+	} else if (!oid ||
+		   bsearch(&k, chg, nchg, sizeof(*chg), tsig_cmp) == NULL) {
+		/* unchanged */
+		free_echs_task(t);
+		return false;
+	} else if (UNLIKELY(_inject_task1(EV_A_ t, u) < 0)) {
+		return false;
+	}
+	wal_append(EV_A_ oid);
+	return true;
+}
+
+static void
+qsig_reload1(EV_P_ struct qsig_s *s, int dfd, const char *fn)
+{
+/* diff FN in DFD against its signature S and apply the differences,
+ * files that aren't ours may only carry tasks of their owner */
+	struct qsig_s new = {0};
+	struct tsig_s *chg = NULL;
+	size_t nchg = 0U;
+	size_t nej = 0U;
+	size_t nin = 0U;
+	uid_t u;
+	char *buf;
+	size_t bz;
+
+	if ((buf = qsig_slurp(&new, &bz, dfd, fn)) == NULL && errno != ENOENT) {
+		/* better luck next time */
+		return;
+	} else if (new.mt == s->mt && new.sz == s->sz && s->mt + 1 < s->rt) {
+		/* untouched */
+		goto out;
+	} else if (qsig_scan(&new, buf ?: "", bz), new.h == s->h) {
+		/* touched but not changed */
+		s->mt = new.mt;
+		s->rt = new.rt;
+		goto out;
+	} else if (UNLIKELY((chg = malloc((new.nt ?: 1U) * sizeof(*chg))) == NULL)) {
+		goto out;
+	}
+
+	/* merge both sorted lists, a change in the calendar bits before
+	 * the first component may change any task */
+	for (size_t i = 0U, j = 0U; i < s->nt || j < new.nt;) {
+		if (j >= new.nt || (i < s->nt && s->t[i].oid < new.t[j].oid)) {
+			/* gone */
+			const echs_toid_t oid = s->t[i++].oid;
+			const _task_t t = get_task(oid);
+
+			if (t == NULL) {
+				continue;
+			} else if ((u = s->ou) == meself.uid) {
+				u = echs_task_owner(t->t);
+			}
+			if (_eject_task1(EV_A_ oid, u) >= 0) {
+				wal_append(EV_A_ oid);
+				nej++;
+			}
+		} else if (i >= s->nt || new.t[j].oid < s->t[i].oid) {
+			/* new */
+			chg[nchg++] = new.t[j++];
+		} else if (new.t[j].h != s->t[i].h || new.hh != s->hh) {
+			/* changed */
+			chg[nchg++] = new.t[j];
+			i++, j++;
+		} else {
+			/* keep as is */
+			i++, j++;
+		}
+	}
+
+	if (nchg) {
+		ical_parser_t pp = NULL;
+
+		if (UNLIKELY(echs_evical_push(&pp, buf, bz) < 0)) {
+			goto out;
+		}
+		u = new.ou != meself.uid ? new.ou : NOT_A_UID;
+		for (echs_instruc_t ins;
+		     (ins = echs_evical_pull(&pp)).v == INSVERB_SCHE;) {
+			nin += _reload_task1(EV_A_ ins.t, u, chg, nchg);
+		}
+		with (echs_instruc_t ins = echs_evical_last_pull(&pp)) {
+			if (ins.v == INSVERB_SCHE) {
+				nin += _reload_task1(EV_A_ ins.t, u, chg, nchg);
+			}
+		}
+	}
+	ECHS_NOTI_LOG("\
+reloaded %s: %zu injected, %zu ejected, %zu untouched",
+		      fn, nin, nej, new.nt - nchg);
+
+	/* this is what it looks like now */
+	free(s->t);
+	*s = new;
+	new.t = NULL;
+out:
+	free(new.t);
+	free(chg);
+	free(buf);
+	return;
+}
+
+static void
+qsig_reload(EV_P)
+{
+/* pick up edited queue files */
+	static unsigned int gen;
+	struct qsig_s *s;
+	echs_oid_t k;
+
+	gen++;
+	if_with (DIR *d, (d = fdopendir(dup(qdirfd))) != NULL) {
+		for (struct dirent *dp; (dp = readdir(d)) != NULL;) {
+			const uid_t u = qfn_uid(dp->d_name);
+
+			if (u == NOT_A_UID) {
+				continue;
+			} else if (UNLIKELY((s = get_qsig(u)) == NULL)) {
+				continue;
+			}
+			qsig_reload1(EV_A_ s, qdirfd, dp->d_name);
+			s->gen = gen;
+		}
+		closedir(d);
+	}
+	/* files that have gone take their tasks with them */
+	for (oidmap_iter_t i = 0U;
+	     qsig_ht != NULL && (s = oidmap_next(&i, qsig_ht, &k));) {
+		char fn[PATH_MAX];
+
+		if (s->gen == gen) {
+			continue;
+		} else if (UNLIKELY(qfn(fn, sizeof(fn), ownr_uid(k)) < 0)) {
+			continue;
+		}
+		qsig_reload1(EV_A_ s, qdirfd, fn);
+		s->gen = gen;
+	}
+	return;
+}
+
+/* drop-in directory, .ics files in there are kept in sync with the
+ * queue the same way SIGHUP reloads the queue files, inotify tells us
+ * which files to look at and events are collected until things have
+ * been quiet for a bit, so that a bulk copy comes as a few batches */
+#define DRP_QUIET	((ev_tstamp)1 / 4)
+#define DRP_LATENCY	((ev_tstamp)2)
+#define DRP_MAXPEND	(65536U)
+
+struct dsig_s {
+	struct qsig_s s;
+	char fn[];
+};
+
+static int drpfd = -1;
+static char *drp_dir;
+/* the signatures are kept across restarts in here, in the spool */
+static const char drp_idxfn[] = "echsd_dropin.idx";
+/* obint(fn) -> struct dsig_s* */
+static oidmap_t drp_ht;
+/* names of files that have seen events since the last batch */
+static char **drpq;
+static size_t ndrpq;
+static size_t zdrpq;
+/* lost track, look at everything */
+static bool drp_allp;
+static ev_io drpio;
+static ev_timer drptim;
+static ev_tstamp drp_first;
+
+static bool
+drp_fn_p(const char *fn)
+{
+	const size_t z = strlen(fn);
+	return *fn != '.' && z > 4U && !strcmp(fn + z - 4U, ".ics");
+}
+
+static struct dsig_s*
+get_dsig(const char *fn)
+{
+	const size_t z = strlen(fn);
+	const echs_oid_t k = obint(fn, z);
+	struct dsig_s *d;
+
+	if (drp_ht == NULL && UNLIKELY((drp_ht = make_oidmap(64U)) == NULL)) {
+		return NULL;
+	} else if ((d = oidmap_get(drp_ht, k)) != NULL) {
+		if (UNLIKELY(strcmp(d->fn, fn))) {
+			ECHS_ERR_LOG("\
+drop-in file `%s' collides with `%s', ignoring", fn, d->fn);
+			return NULL;
+		}
+		return d;
+	} else if (UNLIKELY((d = calloc(1U, sizeof(*d) + z + 1U)) == NULL)) {
+		return NULL;
+	} else if (UNLIKELY(oidmap_put(drp_ht, k, d) < 0)) {
+		free(d);
+		return NULL;
+	}
+	memcpy(d->fn, fn, z + 1U);
+	return d;
+}
+
+static void
+drp_sync1(EV_P_ struct dsig_s *d)
+{
+/* bring the tasks of drop-in file D in line with what's on disk */
+	qsig_reload1(EV_A_ &d->s, drpfd, d->fn);
+	if (!d->s.mt) {
+		/* gone, and so are its tasks */
+		(void)oidmap_del(drp_ht, obint(d->fn, strlen(d->fn)));
+		free(d->s.t);
+		free(d);
+	}
+	return;
+}
+
+static void
+drp_scan(EV_P)
+{
+/* look at every file in the drop-in directory */
+	static unsigned int gen;
+	struct dsig_s *d;
+	echs_oid_t k;
+
+	gen++;
+	if_with (DIR *dp, (dp = fdopendir(dup(drpfd))) != NULL) {
+		for (struct dirent *de; (de = readdir(dp)) != NULL;) {
+			if (!drp_fn_p(de->d_name)) {
+				continue;
+			} else if ((d = get_dsig(de->d_name)) == NULL) {
+				continue;
+			}
+			d->s.gen = gen;
+			drp_sync1(EV_A_ d);
+		}
+		closedir(dp);
+	}
+	/* files that have gone take their tasks with them, syncing them
+	 * drops them off the map so collect them first */
+	with (struct dsig_s **gone = NULL) {
+		size_t ngone = 0U;
+		size_t zgone = 0U;
+
+		for (oidmap_iter_t i = 0U;
+		     drp_ht != NULL && (d = oidmap_next(&i, drp_ht, &k));) {
+			if (d->s.gen == gen) {
+				continue;
+			} else if (ngone >= zgone) {
+				const size_t nuz = (zgone * 2U) ?: 64U;
+				void *nup = realloc(gone, nuz * sizeof(*gone));
+
+				if (UNLIKELY(nup == NULL)) {
+					break;
+				}
+				gone = nup;
+				zgone = nuz;
+			}
+			gone[ngone++] = d;
+		}
+		for (size_t i = 0U; i < ngone; i++) {
+			drp_sync1(EV_A_ gone[i]);
+		}
+		free(gone);
+	}
+	return;
+}
+
+static void
+drp_save(void)
+{
+/* write the drop-in signatures to the spool, so that files removed
+ * while we're down can be told apart from those that are still there */
+	static const char tmpfn[] = ".echsd_dropin.idx";
+	const int fl = O_WRONLY | O_CREAT | O_TRUNC;
+	struct dsig_s *d;
+	echs_oid_t k;
+	int fd;
+
+	if (UNLIKELY((fd = openat(qdirfd, tmpfn, fl, 0600)) < 0)) {
+		ECHS_ERR_LOG("cannot write drop-in index: %s", strerror(errno));
+		return;
+	}
+	fdbang(fd);
+	fdprintf("D %s\n", drp_dir);
+	for (oidmap_iter_t i = 0U;
+	     drp_ht != NULL && (d = oidmap_next(&i, drp_ht, &k));) {
+		const struct qsig_s *x = &d->s;
+
+		fdprintf("F %u %lld %lld %lld %x %x %zu %s\n",
+			 x->ou, (long long int)x->mt, (long long int)x->rt,
+			 (long long int)x->sz, x->h, x->hh, x->nt, d->fn);
+		for (size_t j = 0U; j < x->nt; j++) {
+			fdprintf("T %lx %x\n",
+				 (unsigned long int)x->t[j].oid, x->t[j].h);
+		}
+	}
+	fdflush();
+	if (close(fd) < 0 || renameat(qdirfd, tmpfn, qdirfd, drp_idxfn) < 0) {
+		ECHS_ERR_LOG("cannot write drop-in index: %s", strerror(errno));
+		(void)unlinkat(qdirfd, tmpfn, 0);
+	}
+	return;
+}
+
+static void
+drp_load(void)
+{
+/* read back what drp_save() wrote, if it's about our directory */
+	struct qsig_s tmp;
+	struct dsig_s *d = NULL;
+	/* tasks still to come for D */
+	size_t nd = 0U;
+	char *buf;
+	size_t bz;
+
+	if ((buf = qsig_slurp(&tmp, &bz, qdirfd, drp_idxfn)) == NULL) {
+		return;
+	}
+	buf[bz] = '\0';
+	for (char *bp = buf, *eol; bp < buf + bz; bp = eol + 1U) {
+		unsigned int ou, h, hh;
+		unsigned long int oid;
+		long long int mt, rt, sz;
+		size_t nt;
+		int n = 0;
+
+		if ((eol = strchr(bp, '\n')) == NULL) {
+			/* torn line */
+			break;
+		}
+		*eol = '\0';
+		switch (*bp) {
+		case 'D':
+			if (strcmp(bp + 2U, drp_dir)) {
+				/* some other directory */
+				goto out;
+			}
+			break;
+		case 'F':
+			d = NULL;
+			if (sscanf(bp, "F %u %lld %lld %lld %x %x %zu %n",
+				   &ou, &mt, &rt, &sz, &h, &hh, &nt, &n) < 7 ||
+			    !n || (d = get_dsig(bp + n)) == NULL) {
+				break;
+			}
+			/* should the file be in there twice, last one wins */
+			free(d->s.t);
+			d->s.nt = 0U;
+			if (UNLIKELY((d->s.t = calloc(nt ?: 1U,
+						      sizeof(*d->s.t))) == NULL)) {
+				d = NULL;
+				break;
+			}
+			d->s.ou = ou;
+			d->s.mt = mt;
+			d->s.rt = rt;
+			d->s.sz = sz;
+			d->s.h = h;
+			d->s.hh = hh;
+			d->s.nt = 0U;
+			nd = nt;
+			break;
+		case 'T':
+			if (d == NULL || d->s.nt >= nd) {
+				break;
+			} else if (sscanf(bp, "T %lx %x", &oid, &h) < 2) {
+				break;
+			}
+			d->s.t[d->s.nt++] = (struct tsig_s){oid, h};
+			break;
+		default:
+			break;
+		}
+	}
+out:
+	free(buf);
+	return;
+}
+
+static int
+drpq_cmp(const void *x, const void *y)
+{
+	return strcmp(*(char *const*)x, *(char *const*)y);
+}
+
+static void
+drptim_cb(EV_P_ ev_timer *UNUSED(w), int UNUSED(revents))
+{
+/* quiet for long enough, do the batch */
+	const size_t npend = ndrpq;
+
+	if (drp_allp) {
+		drp_allp = false;
+		drp_scan(EV_A);
+		goto out;
+	}
+	qsort(drpq, ndrpq, sizeof(*drpq), drpq_cmp);
+	for (size_t i = 0U; i < ndrpq; i++) {
+		struct dsig_s *d;
+
+		if (i && !strcmp(drpq[i], drpq[i - 1U])) {
+			/* seen him */
+			continue;
+		} else if ((d = get_dsig(drpq[i])) == NULL) {
+			continue;
+		}
+		drp_sync1(EV_A_ d);
+	}
+out:
+	drp_save();
+	ECHS_NOTI_LOG("drop-in batch of %zu events done", npend);
+	for (size_t i = 0U; i < ndrpq; i++) {
+		free(drpq[i]);
+	}
+	ndrpq = 0U;
+	return;
+}
 
-	if (UNLIKELY(ctx == NULL)) {
+static void
+drp_push(const char *fn)
+{
+	if (drp_allp || !drp_fn_p(fn)) {
+		return;
+	} else if (UNLIKELY(ndrpq >= DRP_MAXPEND)) {
+		/* that's a lot, just rescan the lot */
+		drp_allp = true;
 		return;
+	} else if (ndrpq >= zdrpq) {
+		const size_t nuz = (zdrpq * 2U) ?: 64U;
+		void *nup = realloc(drpq, nuz * sizeof(*drpq));
+
+		if (UNLIKELY(nup == NULL)) {
+			drp_allp = true;
+			return;
+		}
+		drpq = nup;
+		zdrpq = nuz;
 	}
-	if (LIKELY(ctx->loop != NULL)) {
-		ev_break(ctx->loop, EVBREAK_ALL);
-		ev_loop_destroy(ctx->loop);
+	if (UNLIKELY((drpq[ndrpq] = strdup(fn)) == NULL)) {
+		drp_allp = true;
+		return;
 	}
-	free_task_pools();
-	free_chld_pools();
-	free_task_ht();
-	free(ctx);
+	ndrpq++;
 	return;
 }
 
-static int
-_inject_task1(EV_P_ echs_task_t t, uid_t u)
+#if defined HAVE_SYS_INOTIFY_H
+static void
+drpio_cb(EV_P_ ev_io *w, int UNUSED(revents))
 {
-	_task_t res;
-	ncred_t uc;
-	ncred_t oc;
-
-	/* massage owner and u
-	 * we allow U to be set to NOT_A_UID in which case the
-	 * uid will be taken from the compl'd T->owner slot */
-	oc = compl_owner(t->owner);
-	uc = compl_uid(u);
-
-	/* big checking */
-	if (uc.u == NOT_A_UID && oc.u == NOT_A_UID) {
-		/* can't have both unset, bugger off */
-		ECHS_ERR_LOG("\
-ignoring task update with no user nor owner specified");
-		return -1;
-	} else if (uc.u == NOT_A_UID && meself.uid && oc.u != meself.uid) {
-		ECHS_ERR_LOG("\
-need root privileges to run task as user %d", oc.u);
-			return -1;
-	} else if (oc.u == NOT_A_UID && meself.uid && uc.u != meself.uid) {
-		ECHS_ERR_LOG("\
-need root privileges to run task as user %d", uc.u);
-		return -1;
-	} else if (uc.u != NOT_A_UID && oc.u != NOT_A_UID && oc.u != uc.u) {
-		/* we've caught him, call the police!!! */
-		ECHS_ERR_LOG("\
-task update from user %d for task from user %d failed: permission denied",
-			     uc.u, oc.u);
-		return -1;
-	} else if (oc.u == NOT_A_UID && (oc.u = uc.u, false)) {
-		/* not reached */
+	char buf[16384U]
+		__attribute__((aligned(__alignof__(struct inotify_event))));
+	ev_tstamp now;
+	ev_tstamp nap;
+	ssize_t nrd;
 
-	} else if (uc.u == NOT_A_UID && (uc.u = oc.u, false)) {
-		/* not reached */
+	while ((nrd = read(w->fd, buf, sizeof(buf))) > 0) {
+		for (const char *bp = buf, *const ep = buf + nrd; bp < ep;) {
+			const struct inotify_event *e = (const void*)bp;
 
-	} else if (UNLIKELY(t->strm == NULL)) {
-		ECHS_ERR_LOG("submitted ical object is not a task");
-		return -1;
-	} else if ((res = get_task(t->oid)) != NULL &&
-		   !echs_task_owned_by_p(res->t, oc.u)) {
-		/* we've caught him, call the police!!! */
-		ECHS_ERR_LOG("\
-task update from user %d for task from user %d failed: permission denied",
-			     uc.u, echs_task_owner(res->t));
-		return -1;
-	} else if (res != NULL) {
-		ECHS_NOTI_LOG("task update, unscheduling old task");
-		ev_periodic_stop(EV_A_ &res->w);
-		free(deconst(res->dflt_cred.wd));
-		free(deconst(res->dflt_cred.sh));
-		free_echs_task(res->t);
-	} else if (UNLIKELY((res = make_task(t->oid)) == NULL)) {
-		ECHS_ERR_LOG("cannot submit new task");
-		return -1;
+			bp += sizeof(*e) + e->len;
+			if (e->mask & IN_Q_OVERFLOW) {
+				drp_allp = true;
+			} else if (e->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+				ECHS_ERR_LOG("\
+drop-in directory has gone, no longer watching it");
+				ev_io_stop(EV_A_ w);
+			} else if (e->len) {
+				drp_push(e->name);
+			}
+		}
 	}
-	/* refresh the actual credentials again */
-	if (UNLIKELY((uc = compl_uid(uc.u)).u == NOT_A_UID)) {
-		ECHS_ERR_LOG("user %u has vanished", oc.u);
-		return -1;
+	if (!ndrpq && !drp_allp) {
+		/* nothing of interest */
+		return;
 	}
-	/* massage away the owner in the task and
-	 * replace by the connection credentials */
-	echs_task_rset_ownr(t, uc.u);
-	/* bang libechse task into our _task */
-	res->t = t;
-	/* run all tasks as U and the default group of U */
-	res->dflt_cred.u = uc.u;
-	res->dflt_cred.g = uc.g;
-	/* also, by default, in U's home dir using U's shell */
-	res->dflt_cred.wd = strdup(uc.wd);
-	res->dflt_cred.sh = strdup(uc.sh);
 
-	ECHS_NOTI_LOG("scheduling task for user %u(%u)", uc.u, uc.g);
-	ev_periodic_init(&res->w, task_cb, 0./*ignored*/, 0., resched);
-	ev_periodic_start(EV_A_ &res->w);
-	return 0;
+	/* wait for things to calm down but not forever */
+	now = ev_now(EV_A);
+	if (!ev_is_active(&drptim)) {
+		drp_first = now;
+	}
+	if ((nap = drp_first + DRP_LATENCY - now) > DRP_QUIET) {
+		nap = DRP_QUIET;
+	} else if (nap < 0) {
+		nap = 0;
+	}
+	ev_timer_stop(EV_A_ &drptim);
+	ev_timer_set(&drptim, nap, 0);
+	ev_timer_start(EV_A_ &drptim);
+	return;
 }
 
 static int
-_eject_task1(EV_P_ echs_toid_t oid, uid_t uid)
+drp_watch(EV_P_ const char *dir)
 {
-	_task_t res;
+/* open DIR and watch it, then pick up what's in there already */
+	static const uint32_t msk = IN_CLOSE_WRITE | IN_MOVED_TO |
+		IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF |
+		IN_ONLYDIR;
+	int ifd;
 
-	if (UNLIKELY((res = get_task(oid)) == NULL)) {
-		ECHS_ERR_LOG("\
-cannot update task: no task with oid 0x%x found", oid);
-		return -1;
-	} else if (UNLIKELY(!echs_task_owned_by_p(res->t, uid))) {
-		/* we've caught him, call the police!!! */
-		ECHS_ERR_LOG("\
-task update from user %d for task from user %d failed: permission denied",
-			     uid, echs_task_owner(res->t));
+	if (UNLIKELY((drpfd = open(dir, O_RDONLY | O_DIRECTORY)) < 0)) {
 		return -1;
+	} else if (UNLIKELY((drp_dir = realpath(dir, NULL)) == NULL)) {
+		goto clo;
+	} else if (UNLIKELY(fd_cloexec(drpfd) < 0)) {
+		goto clo;
+	} else if (UNLIKELY((ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0)) {
+		goto clo;
+	} else if (UNLIKELY(inotify_add_watch(ifd, dir, msk) < 0)) {
+		close(ifd);
+		goto clo;
 	}
-	/* otherwise proceed with the evacuation */
-	ECHS_NOTI_LOG("cancelling task 0x%x", oid);
-	ev_periodic_stop(EV_A_ &res->w);
-	free_task(res);
+	ev_io_init(&drpio, drpio_cb, ifd, EV_READ);
+	ev_io_start(EV_A_ &drpio);
+	ev_timer_init(&drptim, drptim_cb, 0, 0);
+	/* files may have come and gone while we were away */
+	drp_load();
+	drp_scan(EV_A);
+	drp_save();
 	return 0;
+clo:
+	free(drp_dir);
+	drp_dir = NULL;
+	close(drpfd);
+	drpfd = -1;
+	return -1;
+}
+#else  /* !HAVE_SYS_INOTIFY_H */
+static int
+drp_watch(EV_P_ const char *UNUSED(dir))
+{
+	errno = ENOSYS;
+	return -1;
 }
+#endif	/* HAVE_SYS_INOTIFY_H */
 
+static void
+free_drp(EV_P)
+{
+	struct dsig_s *d;
+	echs_oid_t k;
+
+	if (drpfd < 0) {
+		return;
+	}
+	ev_io_stop(EV_A_ &drpio);
+	ev_timer_stop(EV_A_ &drptim);
+	close(drpio.fd);
+	close(drpfd);
+	drpfd = -1;
+	free(drp_dir);
+	drp_dir = NULL;
+	for (size_t i = 0U; i < ndrpq; i++) {
+		free(drpq[i]);
+	}
+	free(drpq);
+	drpq = NULL;
+	ndrpq = zdrpq = 0U;
+	for (oidmap_iter_t i = 0U;
+	     drp_ht != NULL && (d = oidmap_next(&i, drp_ht, &k));) {
+		free(d->s.t);
+		free(d);
+	}
+	free_oidmap(drp_ht);
+	drp_ht = NULL;
+	return;
+}
 
 static void
 _inject_file(struct _echsd_s *ctx, const char *fn)
@@ -2620,8 +6045,6 @@ _inject_file(struct _echsd_s *ctx, const char *fn)
 
 more:
 	switch ((nrd = read(fd, buf, sizeof(buf)))) {
-		echs_instruc_t ins;
-
 	default:
 		if (echs_evical_push(&pp, buf, nrd) < 0) {
 			/* pushing more brings nothing */
@@ -2629,48 +6052,197 @@ more:
 		}
 		/*@fallthrough@*/
 	case 0:
-		do {
-			ins = echs_evical_pull(&pp);
+		_inject_pull(ctx->loop, &pp);
+		if (LIKELY(nrd > 0)) {
+			goto more;
+		}
+		/*@fallthrough@*/
+	case -1:
+		_inject_last(&pp);
+		break;
+	}
 
-			if (UNLIKELY(ins.v != INSVERB_SCHE)) {
-				break;
-			} else if (UNLIKELY(ins.t == NULL)) {
+	close(fd);
+	return;
+}
+
+static void
+_inject_wal(struct _echsd_s *ctx)
+{
+/* the journal is a concatenation of VCALENDARs but the parser calls
+ * it a day after the first one, so feed it record by record */
+	static const char eor[] = "END:VCALENDAR\n";
+	struct stat st;
+	char *buf;
+	size_t bz = 0U;
+	int fd;
+
+	if ((fd = openat(qdirfd, walfn, O_RDONLY)) < 0) {
+		return;
+	} else if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+		goto clo;
+	} else if (UNLIKELY((buf = malloc(st.st_size)) == NULL)) {
+		ECHS_ERR_LOG("cannot replay queue journal: %s", STRERR);
+		goto clo;
+	}
+	for (ssize_t nrd;
+	     bz < (size_t)st.st_size &&
+		     (nrd = read(fd, buf + bz, st.st_size - bz)) > 0;
+	     bz += nrd);
+
+	for (const char *bp = buf, *const ep = buf + bz, *rp; bp < ep; bp = rp) {
+		ical_parser_t pp = NULL;
+
+		if ((rp = xmemmem(bp, ep - bp, eor, strlenof(eor))) != NULL) {
+			rp += strlenof(eor);
+		} else {
+			/* torn record, the last pull will deal with it */
+			rp = ep;
+		}
+		if (echs_evical_push(&pp, bp, rp - bp) < 0) {
+			continue;
+		}
+		_inject_pull(ctx->loop, &pp);
+		_inject_last(&pp);
+	}
+	free(buf);
+clo:
+	close(fd);
+	return;
+}
+
+/* queue files are parsed in parallel, every worker claims a file,
+ * turns it into tasks and leaves them for the main thread to inject,
+ * libechse's intern and zone tables are guarded for this */
+struct qfile_s {
+	char *fn;
+	echs_task_t *t;
+	size_t nt;
+	size_t zt;
+};
+
+static struct qfile_s *qfiles;
+static size_t nqfiles;
+
+#if defined HAVE_PTHREAD
+static void
+qfile_add_task(struct qfile_s *f, echs_task_t t)
+{
+	if (UNLIKELY(f->nt >= f->zt)) {
+		const size_t nuz = (f->zt * 2U) ?: 256U;
+		void *nup = realloc(f->t, nuz * sizeof(*f->t));
+
+		if (UNLIKELY(nup == NULL)) {
+			free_echs_task(t);
+			return;
+		}
+		f->t = nup;
+		f->zt = nuz;
+	}
+	f->t[f->nt++] = t;
+	return;
+}
+
+static void
+_pull_file(struct qfile_s *f)
+{
+/* like _inject_file() but just collect the tasks */
+	char buf[65536U];
+	ical_parser_t pp = NULL;
+	echs_instruc_t ins;
+	ssize_t nrd;
+	int fd;
+
+	if ((fd = openat(qdirfd, f->fn, O_RDONLY)) < 0) {
+		return;
+	}
+	do {
+		if ((nrd = read(fd, buf, sizeof(buf))) > 0 &&
+		    echs_evical_push(&pp, buf, nrd) < 0) {
+			break;
+		}
+		while ((ins = echs_evical_pull(&pp)).v == INSVERB_SCHE) {
+			if (UNLIKELY(ins.t == NULL)) {
 				continue;
 			} else if (UNLIKELY(!ins.t->oid)) {
 				/* not even an OID */
 				free_echs_task(ins.t);
 				continue;
 			}
-			/* and otherwise inject him */
-			_inject_task1(ctx->loop, ins.t, NOT_A_UID);
-		} while (1);
-		if (LIKELY(nrd > 0)) {
-			goto more;
+			qfile_add_task(f, ins.t);
 		}
-		/*@fallthrough@*/
-	case -1:
-		/* last ever pull this morning */
-		ins = echs_evical_last_pull(&pp);
+	} while (nrd > 0);
+	_inject_last(&pp);
+	close(fd);
+	return;
+}
 
-		if (UNLIKELY(ins.v != INSVERB_SCHE)) {
+static pthread_mutex_t qmtx = PTHREAD_MUTEX_INITIALIZER;
+static size_t iqfiles;
+
+static void*
+qload_thr(void *UNUSED(arg))
+{
+	do {
+		size_t i;
+
+		pthread_mutex_lock(&qmtx);
+		i = iqfiles++;
+		pthread_mutex_unlock(&qmtx);
+
+		if (i >= nqfiles) {
 			break;
-		} else if (UNLIKELY(ins.t != NULL)) {
-			/* that can't be right, we should have got
-			 * the last task in the loop above, this means
-			 * this is a half-finished thing and we don't
-			 * want no half-finished things */
-			free_echs_task(ins.t);
 		}
-		break;
-	}
+		_pull_file(qfiles + i);
+	} while (1);
+	return NULL;
+}
 
-	close(fd);
-	return;
+static size_t
+qload_par(void)
+{
+/* parse all queue files using as many threads as there are cores,
+ * return the number of threads that did the job, 0 if none */
+	long int ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t nthr = ncpu > 1 ? (size_t)ncpu : 1U;
+	pthread_t *thr;
+	size_t i;
+
+	if (nthr > nqfiles) {
+		nthr = nqfiles;
+	}
+	if (nthr <= 1U) {
+		/* not worth the hassle */
+		return 0U;
+	} else if (UNLIKELY((thr = malloc(nthr * sizeof(*thr))) == NULL)) {
+		return 0U;
+	}
+	iqfiles = 0U;
+	for (i = 0U; i < nthr; i++) {
+		if (pthread_create(thr + i, NULL, qload_thr, NULL)) {
+			break;
+		}
+	}
+	if (!i) {
+		/* none at all */
+		free(thr);
+		return 0U;
+	}
+	/* the ones we've got will do all files */
+	nthr = i;
+	for (i = 0U; i < nthr; i++) {
+		pthread_join(thr[i], NULL);
+	}
+	free(thr);
+	return nthr;
 }
+#endif	/* HAVE_PTHREAD */
 
 static void
 echsd_inject_queues(struct _echsd_s *ctx, const char *qd)
 {
+	size_t zqfiles = 0U;
+
 	/* we are a super-echsd, load all .ics files we can find */
 	if_with (DIR *d, d = opendir(qd)) {
 		static const char prfx[] = "echsq_";
@@ -2693,11 +6265,80 @@ echsd_inject_queues(struct _echsd_s *ctx, const char *qd)
 				/* nope */
 				continue;
 			}
-			/* otherwise, try and load it */
-			_inject_file(ctx, fn);
+			/* otherwise, remember it for loading */
+			if (nqfiles >= zqfiles) {
+				const size_t nuz = (zqfiles * 2U) ?: 64U;
+				void *nup = realloc(qfiles, nuz * sizeof(*qfiles));
+
+				if (UNLIKELY(nup == NULL)) {
+					/* load him right away then */
+					_inject_file(ctx, fn);
+					continue;
+				}
+				qfiles = nup;
+				zqfiles = nuz;
+			}
+			qfiles[nqfiles++] = (struct qfile_s){.fn = strdup(fn)};
 		}
 		closedir(d);
 	}
+
+#if defined HAVE_PTHREAD
+	if (qload_par()) {
+		/* all parsed, just inject them in order */
+		for (size_t i = 0U; i < nqfiles; i++) {
+			const struct qfile_s *f = qfiles + i;
+
+			for (size_t j = 0U; j < f->nt; j++) {
+				_inject_task1(ctx->loop, f->t[j], NOT_A_UID);
+			}
+		}
+	} else
+#endif	/* HAVE_PTHREAD */
+	for (size_t i = 0U; i < nqfiles; i++) {
+		if (LIKELY(qfiles[i].fn != NULL)) {
+			_inject_file(ctx, qfiles[i].fn);
+		}
+	}
+
+	for (size_t i = 0U; i < nqfiles; i++) {
+		free(qfiles[i].fn);
+		free(qfiles[i].t);
+	}
+	free(qfiles);
+	qfiles = NULL;
+	nqfiles = 0U;
+	return;
+}
+
+static void
+echsd_replay_wal(struct _echsd_s *ctx)
+{
+/* replay the queue journal on top of the snapshots, then keep it open
+ * for appending */
+	const int fl = O_WRONLY | O_APPEND | O_CREAT;
+	struct stat st;
+
+	_inject_wal(ctx);
+
+	if (UNLIKELY((walfd = openat(qdirfd, walfn, fl, 0600)) < 0)) {
+		ECHS_ERR_LOG("\
+cannot open queue journal, checkpointing every minute: %s", STRERR);
+		return;
+	}
+	(void)fd_cloexec(walfd);
+	if (fstat(walfd, &st) < 0 || !st.st_size) {
+		return;
+	}
+	/* fold the replayed bits into the snapshots right away */
+	walz = st.st_size;
+	walt = ev_now(ctx->loop);
+	if (chkpnta() < 0 || chkpnt_sync() < 0) {
+		/* keep the journal then */
+		return;
+	}
+	wal_reset();
+	return;
 }
 
 static void
@@ -2769,6 +6410,32 @@ main(int argc, char *argv[])
 		goto out;
 	}
 
+	/* checkpoint in the background? */
+	chkpnt_bgp = argi->bg_checkpoint_flag;
+	/* latencies per task? */
+	task_histp = argi->task_histograms_flag;
+	/* how many clients at once? */
+	if (argi->max_connections_arg) {
+		conn_max = strtoul(argi->max_connections_arg, NULL, 10) ?: 1U;
+	}
+	/* how many jobs at once? */
+	if (argi->max_jobs_arg) {
+		run_max = strtoul(argi->max_jobs_arg, NULL, 10);
+	}
+	/* user weights and rates */
+	for (size_t i = 0U; i < argi->user_share_nargs; i++) {
+		if (UNLIKELY(share_conf(argi->user_share_args[i]) < 0)) {
+			fprintf(stderr, "\
+Error: cannot make sense of user share `%s'\n", argi->user_share_args[i]);
+			rc = 1;
+			goto out;
+		}
+	}
+	/* keep far-off tasks serialised? */
+	if (argi->horizon_arg) {
+		horizon = strtod(argi->horizon_arg, NULL);
+	}
+
 	if (argi->foreground_flag) {
 		echs_log = echs_errlog;
 	} else if (daemonise() < 0) {
@@ -2814,7 +6481,21 @@ main(int argc, char *argv[])
 	echsd_inject_sock(ctx, esok);
 
 	/* inject our state, i.e. read all echsq files */
+	make_pwcache();
 	echsd_inject_queues(ctx, qdir);
+	/* and everything that happened since they were written */
+	echsd_replay_wal(ctx);
+	/* remember what they look like, for reloads */
+	qsig_sign_all();
+	/* keep up with the drop-in directory */
+	if (argi->drop_in_arg && drp_watch(ctx->loop, argi->drop_in_arg) < 0) {
+		ECHS_ERR_LOG("cannot watch drop-in directory `%s': %s",
+			     argi->drop_in_arg, strerror(errno));
+		free_pwcache();
+		rc = 1;
+		goto fre;
+	}
+	free_pwcache();
 
 	/* main loop */
 	{
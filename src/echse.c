@@ -592,12 +592,7 @@ more:
 			}
 			/* unwind him, maybe */
 			if (ins.t->strm) {
-				echs_event_t e;
-				while ((e = echs_evstrm_next(ins.t->strm),
-					!echs_nul_event_p(e)) &&
-				       echs_instant_lt_p(e.from, unr_till)) {
-					(void)echs_evstrm_pop(ins.t->strm);
-				}
+				echs_evstrm_seek(ins.t->strm, unr_till);
 			}
 			/* and otherwise inject him */
 			echs_task_icalify(STDOUT_FILENO, ins.t);
@@ -685,6 +680,12 @@ echse: Error: cannot open file `%s'", fn);
 	/* noone needs the streams in an array anymore */
 	free_strms();
 
+	if (argi->from_arg) {
+		/* fast forward, events before FROM are skipped below anyway
+		 * but this way streams get a chance to skip them wholesale */
+		echs_evstrm_seek(smux, p.from);
+	}
+
 	if (argi->format_arg != NULL && !strcmp(argi->format_arg, "ical")) {
 		/* special output format */
 		unroll_ical(smux, &p);
@@ -328,6 +328,11 @@ free_conn(int s)
 /* counter for outstanding requests */
 static size_t nout;
 
+/* bulk submissions are serialised into a temp file first so that the
+ * number of tasks can be announced up front */
+static FILE *bulkf;
+static size_t nbulk;
+
 static int massage(echs_task_t t);
 
 static int
@@ -398,18 +403,22 @@ poll1(int fd, int timeo)
 	return 0;
 }
 
-static void
+static int
 add_fd(int tgt_fd, int src_fd)
 {
+/* inject the tasks in SRC_FD, or put them in the bulk file,
+ * return -1 if some of them had to be left out */
 	char buf[32768U];
 	ical_parser_t pp = NULL;
 	ssize_t nrd;
+	int rc = 0;
 
 more:
 	nrd = read(src_fd, buf, sizeof(buf));
 	if (nrd > 0) {
 		if (echs_evical_push(&pp, buf, nrd) < 0) {
 			/* pushing more brings nothing */
+			rc = -1;
 			goto done;
 		}
 		/* fallthrough */
@@ -423,8 +432,17 @@ more:
 			if (UNLIKELY(ins.v != INSVERB_SCHE)) {
 				break;
 			} else if (UNLIKELY(ins.t == NULL)) {
+				rc = -1;
 				continue;
 			} else if (UNLIKELY(massage(ins.t) < 0)) {
+				free_echs_task(ins.t);
+				rc = -1;
+				continue;
+			} else if (bulkf != NULL) {
+				/* keep him for later */
+				echs_task_icalify(fileno(bulkf), ins.t);
+				free_echs_task(ins.t);
+				nbulk++;
 				continue;
 			}
 			/* and otherwise inject him */
@@ -456,7 +474,34 @@ more:
 		poll1(tgt_fd, 0);
 	}
 done:
-	return;
+	return rc;
+}
+
+static int
+send_bulk(int tgt_fd)
+{
+/* announce the tasks kept in the bulk file and send them off */
+	char buf[32768U];
+	const int fd = fileno(bulkf);
+	ssize_t nrd;
+
+	if (UNLIKELY(lseek(fd, 0, SEEK_SET) < 0)) {
+		return -1;
+	}
+	echs_icalify_init(tgt_fd, (echs_instruc_t){.v = INSVERB_SCHE});
+	echs_icalify_bulk(tgt_fd, nbulk);
+	while ((nrd = read(fd, buf, sizeof(buf))) > 0) {
+		for (ssize_t nwr, tot = 0; tot < nrd; tot += nwr) {
+			nwr = write(tgt_fd, buf + tot, nrd - tot);
+			if (UNLIKELY(nwr < 0)) {
+				return -1;
+			}
+		}
+	}
+	echs_icalify_fini(tgt_fd);
+	/* there's just the one reply */
+	nout = 1U;
+	return nrd < 0 ? -1 : 0;
 }
 
 static const char*
@@ -850,6 +895,96 @@ http_ret_cod(const char *buf, char *cod[static 1U], size_t bsz)
 	return rc;
 }
 
+/* chunked transfer decoding, the framing only ever takes bytes away
+ * so this can be done in place */
+static struct {
+	enum {
+		CHNK_NONE,
+		CHNK_SIZE,
+		CHNK_EXT,
+		CHNK_DATA,
+		CHNK_TRLR,
+		CHNK_DONE,
+	} st;
+	size_t left;
+} chnk;
+
+static void
+http_chunked(const char *hdr, size_t hz)
+{
+/* prepare dechunk() for a reply with header HDR */
+	static const char te[] = "Transfer-Encoding: chunked";
+
+	chnk.st = xmemmem(hdr, hz, te, strlenof(te)) < hz
+		? CHNK_SIZE : CHNK_NONE;
+	chnk.left = 0U;
+	return;
+}
+
+static size_t
+dechunk(char *restrict buf, size_t bsz)
+{
+/* strip chunk framing off BUF, return the size of what's left */
+	size_t ri = 0U;
+	size_t wi = 0U;
+
+	if (chnk.st == CHNK_NONE) {
+		return bsz;
+	}
+	while (ri < bsz) {
+		switch (chnk.st) {
+			char c;
+
+		case CHNK_SIZE:
+			switch ((c = buf[ri++])) {
+			case '0' ... '9':
+				chnk.left = chnk.left * 16U + (c - '0');
+				break;
+			case 'a' ... 'f':
+				chnk.left = chnk.left * 16U + (c - 'a' + 10);
+				break;
+			case 'A' ... 'F':
+				chnk.left = chnk.left * 16U + (c - 'A' + 10);
+				break;
+			case '\n':
+				chnk.st = chnk.left ? CHNK_DATA : CHNK_DONE;
+				break;
+			default:
+				/* \r or extensions */
+				chnk.st = CHNK_EXT;
+				break;
+			}
+			break;
+		case CHNK_EXT:
+			if (buf[ri++] == '\n') {
+				chnk.st = chnk.left ? CHNK_DATA : CHNK_DONE;
+			}
+			break;
+		case CHNK_DATA:
+			with (size_t n = bsz - ri < chnk.left ? bsz - ri : chnk.left) {
+				memmove(buf + wi, buf + ri, n);
+				wi += n;
+				ri += n;
+				if (!(chnk.left -= n)) {
+					chnk.st = CHNK_TRLR;
+				}
+			}
+			break;
+		case CHNK_TRLR:
+			if (buf[ri++] == '\n') {
+				chnk.st = CHNK_SIZE;
+			}
+			break;
+		default:
+		case CHNK_DONE:
+			/* trailers, we don't care */
+			ri = bsz;
+			break;
+		}
+	}
+	return wi;
+}
+
 static int
 brief_list(int tgtfd, int srcfd)
 {
@@ -879,17 +1014,22 @@ server returned: %s", cod);
 		return -1;
 	}
 
-	if (UNLIKELY(nrd - beef <= 0)) {
+	http_chunked(buf, beef);
+
+	/* payload only from here on */
+	nrd = dechunk(buf + beef, nrd - beef);
+	while (UNLIKELY(nrd <= 0)) {
 		/* have to do another roundtrip to the reader */
-		nrd = read(srcfd, buf, sizeof(buf));
+		if ((nrd = read(srcfd, buf, sizeof(buf))) <= 0) {
+			/* no chance then, bugger off */
+			errno = 0, serror("\
+Error: incomplete reply from server");
+			return -1;
+		}
+		nrd = dechunk(buf, nrd);
 		beef = 0;
 	}
-	if (UNLIKELY(nrd - beef <= 0)) {
-		/* no chance then, bugger off */
-		errno = 0, serror("\
-Error: incomplete reply from server");
-		return -1;
-	} else if (echs_evical_push(&pp, buf + beef, nrd - beef) < 0) {
+	if (echs_evical_push(&pp, buf + beef, nrd) < 0) {
 		/* pushing won't help */
 		errno = 0, serror("\
 Error: incomplete reply from server");
@@ -903,7 +1043,10 @@ more:
 		echs_instruc_t ins;
 
 	default:
-		if (echs_evical_push(&pp, buf, nrd) < 0) {
+		if (!(nrd = dechunk(buf, nrd))) {
+			/* just framing */
+			goto more;
+		} else if (echs_evical_push(&pp, buf, nrd) < 0) {
 			/* pushing more brings nothing */
 			break;
 		}
@@ -984,12 +1127,13 @@ server returned: %s", cod);
 	}
 	/* off we go */
 	fdbang(tgtfd);
+	http_chunked(buf, beef);
 
 	/* write out initial portion of data we've got */
-	fdwrite(buf + beef, nrd - beef);
+	fdwrite(buf + beef, dechunk(buf + beef, nrd - beef));
 
 	while ((nrd = read(srcfd, buf, sizeof(buf))) > 0) {
-		fdwrite(buf, nrd);
+		fdwrite(buf, dechunk(buf, nrd));
 	}
 	fdflush();
 	return 0;
@@ -1186,7 +1330,12 @@ cmd_add(const struct yuck_cmd_add_s argi[static 1U])
 		return 1;
 	}
 
-	echs_icalify_init(s, (echs_instruc_t){INSVERB_SCHE});
+	if (!argi->bulk_flag) {
+		echs_icalify_init(s, (echs_instruc_t){INSVERB_SCHE});
+	} else if (UNLIKELY((bulkf = tmpfile()) == NULL)) {
+		serror("Error: cannot create temporary file");
+		return 1;
+	}
 	if (use_tmpl_p) {
 		/* template mode,
 		 * gcc might think we haven't init'd fd but fact is
@@ -1206,14 +1355,37 @@ cmd_add(const struct yuck_cmd_add_s argi[static 1U])
 		} else if (UNLIKELY((fd = open(fn, O_RDONLY)) < 0)) {
 			serror("\
 Error: cannot open file `%s'", fn);
+			if (bulkf != NULL) {
+				/* all or nothing, remember? */
+				goto bulk_err;
+			}
 			continue;
 		}
 
 	proc:
-		add_fd(s, fd);
+		if (UNLIKELY(add_fd(s, fd) < 0) && bulkf != NULL) {
+			/* all or nothing still */
+			serror("\
+Error: cannot submit all tasks, submitting none");
+			close(fd);
+			goto bulk_err;
+		}
 		close(fd);
 	}
-	echs_icalify_fini(s);
+	if (bulkf == NULL) {
+		echs_icalify_fini(s);
+	} else if (UNLIKELY(send_bulk(s) < 0)) {
+		serror("Error: cannot submit tasks");
+		goto bulk_err;
+	} else {
+		fclose(bulkf);
+		bulkf = NULL;
+		/* echsd can't be sure the calendar is complete until
+		 * we stop talking, so stop talking */
+		if (!argi->dry_run_flag) {
+			(void)shutdown(s, SHUT_WR);
+		}
+	}
 
 	if (argi->dry_run_flag) {
 		/* nothing is outstanding in dry-run mode */
@@ -1225,6 +1397,14 @@ Error: cannot open file `%s'", fn);
 
 	free_conn(s);
 	return 0;
+
+bulk_err:
+	fclose(bulkf);
+	bulkf = NULL;
+	if (!argi->dry_run_flag) {
+		free_conn(s);
+	}
+	return 1;
 }
 
 static int
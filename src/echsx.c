@@ -40,6 +40,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdarg.h>
 #include <string.h>
 #include <stdio.h>
@@ -58,6 +59,9 @@
 #if defined HAVE_NET_PROTO_UIPC_H
 # include <net/proto_uipc.h>
 #endif	/* HAVE_NET_PROTO_UIPC_H */
+#if defined __linux__
+# include <sys/syscall.h>
+#endif	/* __linux__ */
 #include <pwd.h>
 #include <grp.h>
 #include <ev.h>
@@ -71,6 +75,8 @@
 #include "intern.h"
 #include "evical.h"
 #include "nummapstr.h"
+#include "oidmap.h"
+#include "xjob.h"
 
 #if defined __INTEL_COMPILER
 # define auto	static
@@ -1042,13 +1048,92 @@ cannot spawn `sendmail': %s", STRERR);
 	return rc;
 }
 
+/* in job server mode executors pass their journal records on to the
+ * server which appends them in batches, see xlog_cb() */
+static int xlog_fd = -1;
+static uint32_t xlog_uid;
+
+/* records are rendered in full before they go anywhere, in job server
+ * mode they have to fit a journal frame, so fields of arbitrary length
+ * are clamped to this */
+#define JREC_MAXFLD	(XJOB_MAXZ / 4U)
+
+struct jrec_s {
+	char *buf;
+	size_t bi;
+	size_t bz;
+};
+
+static int
+jrec_grow(struct jrec_s *r, size_t n)
+{
+	if (r->bi + n > r->bz) {
+		size_t nuz = r->bz ?: 4096U;
+		void *nup;
+
+		while (r->bi + n > nuz) {
+			nuz *= 2U;
+		}
+		if (UNLIKELY((nup = realloc(r->buf, nuz)) == NULL)) {
+			return -1;
+		}
+		r->buf = nup;
+		r->bz = nuz;
+	}
+	return 0;
+}
+
+static void
+jrec_write(struct jrec_s *r, const char *str, size_t len)
+{
+	if (LIKELY(jrec_grow(r, len) >= 0)) {
+		memcpy(r->buf + r->bi, str, len);
+		r->bi += len;
+	}
+	return;
+}
+
+static __attribute__((format(printf, 2, 3))) void
+jrec_printf(struct jrec_s *r, const char *fmt, ...)
+{
+	va_list vap;
+	int n;
+
+	va_start(vap, fmt);
+	n = vsnprintf(NULL, 0, fmt, vap);
+	va_end(vap);
+	if (UNLIKELY(n < 0 || jrec_grow(r, n + 1U) < 0)) {
+		return;
+	}
+	va_start(vap, fmt);
+	vsnprintf(r->buf + r->bi, r->bz - r->bi, fmt, vap);
+	va_end(vap);
+	r->bi += n;
+	return;
+}
+
+static void
+jrec_field(struct jrec_s *r, const char *fld, const char *str, size_t len)
+{
+/* write FLD with value STR of length LEN, clamped if need be */
+	if (xlog_fd >= 0 && len > JREC_MAXFLD) {
+		len = JREC_MAXFLD;
+	}
+	jrec_write(r, fld, strlen(fld));
+	jrec_write(r, str, len);
+	jrec_write(r, "\n", 1U);
+	return;
+}
+
 static int
 jlog_task(echsx_task_t t)
 {
 	static const char jhdr[] = "BEGIN:VTODO\n";
 	static const char jftr[] = "END:VTODO\n";
 	static char stmp[32U] = "CODTSTAMP:";
+	struct jrec_s r = {NULL};
 	size_t nstmp;
+	int rc = 0;
 
 	if (t->t_end.tv_sec <= 0 && time(&t->t_end.tv_sec) == (time_t)-1) {
 		/* shit! */
@@ -1057,15 +1142,8 @@ cannot obtain current time: %s", STRERR);
 		return -1;
 	}
 
-	fdbang(STDOUT_FILENO);
-	if (fdlock(STDOUT_FILENO) < 0) {
-		ECHS_ERR_LOG("\
-cannot obtain lock: %s", STRERR);
-		return -1;
-	}
-
 	/* introduce ourselves */
-	fdwrite(jhdr, strlenof(jhdr));
+	jrec_write(&r, jhdr, strlenof(jhdr));
 	/* start off with the stamp and uid */
 	with (echs_instant_t te = epoch_to_echs_instant(t->t_end.tv_sec)) {
 		size_t n;
@@ -1073,18 +1151,15 @@ cannot obtain lock: %s", STRERR);
 		n = strlenof("XXDTSTAMP:");
 		n += dt_strf_ical(stmp + n, sizeof(stmp) - n, te);
 		stmp[n++] = '\n';
-		fdwrite(stmp + 2U, n - 2U);
+		jrec_write(&r, stmp + 2U, n - 2U);
 		/* keep track of this for later */
 		nstmp = n;
 	}
 
 	if (LIKELY(t->t->oid)) {
-		static const char fld[] = "UID:";
 		const char *tid = obint_name(t->t->oid);
 
-		fdwrite(fld, strlenof(fld));
-		fdwrite(tid, strlen(tid));
-		fdputc('\n');
+		jrec_field(&r, "UID:", tid, strlen(tid));
 	}
 
 	/* write start/completed (and their high-res counterparts?) */
@@ -1096,43 +1171,32 @@ cannot obtain lock: %s", STRERR);
 		n = strlenof("DTSTART:");
 		n += dt_strf_ical(strt + n, sizeof(strt) - n, ts);
 		strt[n++] = '\n';
-		fdwrite(strt, n);
+		jrec_write(&r, strt, n);
 	}
 	memcpy(stmp + 2U, "MPLETED:", strlenof("MPLETED:"));
-	fdwrite(stmp, nstmp);
-
-	with (size_t cmdz = strlen(t->t->cmd)) {
-		static char fld[] = "SUMMARY:";
-		char sum[cmdz + strlenof(fld) + 1U];
-		size_t si;
+	jrec_write(&r, stmp, nstmp);
 
-		si = xstrlncpy(sum, sizeof(sum), fld, strlenof(fld));
-		si += xstrlncpy(sum + si, sizeof(sum) - si, t->t->cmd, cmdz);
-		sum[si++] = '\n';
-		fdwrite(sum, si);
-	}
+	jrec_field(&r, "SUMMARY:", t->t->cmd, strlen(t->t->cmd));
 
 	if (t->errmsg || t->xc < 0) {
 		static const char canc[] = "STATUS:CANCELLED\n";
-		static const char desc[] = "DESCRIPTION:";
 		static const char nrun[] = "not run for reasons unknown";
-		fdwrite(canc, strlenof(canc));
-		fdwrite(desc, strlenof(desc));
+
+		jrec_write(&r, canc, strlenof(canc));
 		if (t->errmsg) {
-			fdwrite(t->errmsg, t->errmsz);
+			jrec_field(&r, "DESCRIPTION:", t->errmsg, t->errmsz);
 		} else {
-			fdwrite(nrun, strlenof(nrun));
+			jrec_field(&r, "DESCRIPTION:", nrun, strlenof(nrun));
 		}
-		fdputc('\n');
 		goto flsh;
 	}
 
 	if (WIFEXITED(t->xc)) {
-		fdprintf("\
+		jrec_printf(&r, "\
 X-EXIT-STATUS:%d\n", WEXITSTATUS(t->xc));
 	} else if (WIFSIGNALED(t->xc)) {
 		int sig = WTERMSIG(t->xc);
-		fdprintf("\
+		jrec_printf(&r, "\
 X-EXIT-STATUS:%d\n\
 X-SIGNAL:%d\n\
 X-SIGNAL-STRING:%s\n", 128 ^ sig, sig, strsignal(sig));
@@ -1154,27 +1218,47 @@ X-SIGNAL-STRING:%s\n", 128 ^ sig, sig, strsignal(sig));
 			? WTERMSIG(t->xc) ^ 128
 			: -1;
 
-		fdprintf("\
+		jrec_printf(&r, "\
 X-USER-TIME:%ld.%06lis\n\
 X-SYSTEM-TIME:%ld.%06lis\n\
 X-REAL-TIME:%ld.%09lis\n", user.s, user.u, sys.s, sys.u, real.s, real.n);
-		fdprintf("\
+		jrec_printf(&r, "\
 X-CPU-USAGE:%.2f%%\n", cpu);
-		fdprintf("\
+		jrec_printf(&r, "\
 X-MEM-USAGE:%ldkB\n", t->rus.ru_maxrss);
 
-		fdprintf("\
+		jrec_printf(&r, "\
 DESCRIPTION:$?=%d  %ldkB mem\\n\n\
  %ld.%06lis user  %ld.%06lis sys  %.2f%% cpu  %ld.%09lis real\n",
-			 s, t->rus.ru_maxrss,
-			 user.s, user.u, sys.s, sys.u, cpu, real.s, real.n);
+			    s, t->rus.ru_maxrss,
+			    user.s, user.u, sys.s, sys.u, cpu, real.s, real.n);
 	}
 
 flsh:
-	fdwrite(jftr, strlenof(jftr));
-	fdflush();
-	for (size_t i = 3U; i && fdunlck(STDOUT_FILENO) < 0; i--);
-	return 0;
+	jrec_write(&r, jftr, strlenof(jftr));
+	if (xlog_fd >= 0) {
+		/* the record is sent off as a whole, nothing to lock */
+		if (UNLIKELY(xlog_send(xlog_fd, xlog_uid, r.buf, r.bi) < 0)) {
+			ECHS_ERR_LOG("\
+cannot pass on journal record: %s", STRERR);
+			rc = -1;
+		}
+	} else if (fdlock(STDOUT_FILENO) < 0) {
+		ECHS_ERR_LOG("\
+cannot obtain lock: %s", STRERR);
+		rc = -1;
+	} else {
+		for (ssize_t nwr, twr = 0; (size_t)twr < r.bi; twr += nwr) {
+			nwr = write(STDOUT_FILENO, r.buf + twr, r.bi - twr);
+			if (UNLIKELY(nwr <= 0)) {
+				rc = -1;
+				break;
+			}
+		}
+		for (size_t i = 3U; i && fdunlck(STDOUT_FILENO) < 0; i--);
+	}
+	free(r.buf);
+	return rc;
 }
 
 static void
@@ -1393,20 +1477,643 @@ clean_up:
 	return rc;
 }
 
+
+/* job server mode, echsd sends us job frames on stdin, for each of
+ * those we fork off an executor (that's all of the above) and report
+ * its wait status and resource usage back once it's finished */
+static ev_io xsrv;
+static ev_signal xchld;
+/* executor pid -> job id */
+static oidmap_t xpids;
+/* results echsd isn't ready for yet, XRESI is the next one to go */
+static struct xres_s *xress;
+static size_t xresi;
+static size_t nxress;
+static size_t zxress;
+static ev_io xout;
+
+/* journals, executors send us their records over XLOG and we append
+ * them in batches, one write() per journal before the loop goes back to
+ * sleep, there's one per user that ran jobs here, not too many then */
+static struct jbat_s {
+	uint32_t uid;
+	int fd;
+	char *buf;
+	size_t bi;
+	size_t bz;
+} *jbats;
+static size_t njbats;
+static size_t zjbats;
+static int xlog[2U] = {-1, -1};
+static ev_io xlogw;
+static ev_prepare xflsh;
+
+/* write out a batch once it's got this big */
+#define JBAT_MAXZ	(65536U)
+
+static void
+jbat_flush(struct jbat_s *b)
+{
+	for (ssize_t nwr, twr = 0; (size_t)twr < b->bi; twr += nwr) {
+		/* journals are O_APPEND, one write() is one batch */
+		nwr = write(b->fd, b->buf + twr, b->bi - twr);
+		if (UNLIKELY(nwr <= 0)) {
+			ECHS_ERR_LOG("\
+cannot write journal of user %u: %s", b->uid, STRERR);
+			break;
+		}
+	}
+	b->bi = 0U;
+	return;
+}
+
+static struct jbat_s*
+jbat_get(uint32_t uid)
+{
+	for (size_t i = 0U; i < njbats; i++) {
+		if (jbats[i].uid == uid) {
+			return jbats + i;
+		}
+	}
+	return NULL;
+}
+
 static int
-daemonise(void)
+jbat_put(uint32_t uid, int fd)
 {
-	switch (fork()) {
-	case -1:
+/* make FD the journal of UID, FD is ours now */
+	struct jbat_s *b;
+
+	if ((b = jbat_get(uid)) != NULL) {
+		struct stat old, new;
+
+		if (fstat(b->fd, &old) >= 0 && fstat(fd, &new) >= 0 &&
+		    old.st_dev == new.st_dev && old.st_ino == new.st_ino) {
+			/* same file */
+			close(fd);
+			return 0;
+		}
+		/* journal's been rotated or removed, what's batched up
+		 * belongs to the old one still */
+		jbat_flush(b);
+		close(b->fd);
+		(void)fd_cloexec(fd);
+		b->fd = fd;
+		return 0;
+	} else if (UNLIKELY(njbats >= zjbats)) {
+		const size_t nuz = (zjbats * 2U) ?: 16U;
+		void *nup = realloc(jbats, nuz * sizeof(*jbats));
+
+		if (UNLIKELY(nup == NULL)) {
+			close(fd);
+			return -1;
+		}
+		jbats = nup;
+		zjbats = nuz;
+	}
+	/* keep executors' jobs from inheriting this */
+	(void)fd_cloexec(fd);
+	jbats[njbats++] = (struct jbat_s){.uid = uid, .fd = fd};
+	return 0;
+}
+
+static void
+free_jbats(void)
+{
+	for (size_t i = 0U; i < njbats; i++) {
+		jbat_flush(jbats + i);
+		close(jbats[i].fd);
+		free(jbats[i].buf);
+	}
+	free(jbats);
+	jbats = NULL;
+	njbats = zjbats = 0U;
+	return;
+}
+
+static void
+xlog_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+	static char buf[XJOB_MAXZ];
+	struct jbat_s *b;
+	uint32_t uid;
+	ssize_t nrd;
+
+	while ((nrd = xlog_recv(w->fd, &uid, buf, sizeof(buf))) > 0) {
+		if (UNLIKELY((b = jbat_get(uid)) == NULL)) {
+			ECHS_ERR_LOG("no journal for user %u, record lost", uid);
+			continue;
+		} else if (b->bi + nrd > b->bz) {
+			size_t nuz = (b->bz * 2U) ?: 4096U;
+			void *nup;
+
+			while (b->bi + nrd > nuz) {
+				nuz *= 2U;
+			}
+			if (UNLIKELY((nup = realloc(b->buf, nuz)) == NULL)) {
+				ECHS_ERR_LOG("\
+cannot batch journal record of user %u, record lost", uid);
+				continue;
+			}
+			b->buf = nup;
+			b->bz = nuz;
+		}
+		memcpy(b->buf + b->bi, buf, nrd);
+		b->bi += nrd;
+
+		if (b->bi >= JBAT_MAXZ) {
+			/* big enough a batch */
+			jbat_flush(b);
+		}
+	}
+	if (UNLIKELY(nrd < 0 && errno == EMSGSIZE)) {
+		ECHS_ERR_LOG("cannot receive journal record: %s", STRERR);
+	}
+	return;
+}
+
+static void
+xflsh_cb(EV_P_ ev_prepare *UNUSED(w), int UNUSED(revents))
+{
+	for (size_t i = 0U; i < njbats; i++) {
+		if (jbats[i].bi) {
+			jbat_flush(jbats + i);
+		}
+	}
+	return;
+}
+
+static echs_task_t
+xjob_task(const char *buf, size_t bsz)
+{
+/* there's one VTODO in BUF, parse it and return it */
+	ical_parser_t pp = NULL;
+	echs_instruc_t ins;
+	echs_task_t res = NULL;
+
+	if (echs_evical_push(&pp, buf, bsz) < 0) {
+		/* nothing to pull then */
+		goto last;
+	}
+	while ((ins = echs_evical_pull(&pp)).v == INSVERB_SCHE) {
+		if (ins.t == NULL) {
+			continue;
+		} else if (res == NULL && ins.t->oid) {
+			res = ins.t;
+			continue;
+		}
+		/* only one per frame */
+		free_echs_task(ins.t);
+	}
+last:
+	ins = echs_evical_last_pull(&pp);
+	if (ins.v == INSVERB_SCHE && ins.t != NULL) {
+		free_echs_task(ins.t);
+	}
+	return res;
+}
+
+static void
+xout_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+/* echsd is ready for more, send what's queued up */
+	for (; xresi < nxress; xresi++) {
+		const struct xres_s *r = xress + xresi;
+
+		if (xres_send(w->fd, r->jid, r->st, &r->ru) >= 0) {
+			continue;
+		} else if (errno == EINTR || errno == EAGAIN) {
+			return;
+		}
+		ECHS_ERR_LOG("\
+cannot report back on job %u: %s", r->jid, STRERR);
+	}
+	xresi = nxress = 0U;
+	ev_io_stop(EV_A_ w);
+	return;
+}
+
+static void
+xres_put(EV_P_ uint32_t jid, int st, const struct rusage *ru)
+{
+/* send result ST of JID to echsd, or queue it up if echsd's still busy
+ * reading, blocking here would deadlock with echsd blocking on jobs */
+	if (!ev_is_active(&xsrv)) {
+		/* nobody's listening */
+		return;
+	} else if (xresi < nxress) {
+		/* others are before us */
+		;
+	} else if (xres_send(xsrv.fd, jid, st, ru) >= 0) {
+		return;
+	} else if (errno != EINTR && errno != EAGAIN) {
+		goto err;
+	}
+	if (UNLIKELY(nxress >= zxress)) {
+		const size_t nuz = (zxress * 2U) ?: 64U;
+		void *nup = realloc(xress, nuz * sizeof(*xress));
+
+		if (UNLIKELY(nup == NULL)) {
+			goto err;
+		}
+		xress = nup;
+		zxress = nuz;
+	}
+	xress[nxress] = (struct xres_s){.jid = jid, .st = st};
+	if (ru != NULL) {
+		xress[nxress].ru = *ru;
+	}
+	nxress++;
+	ev_io_start(EV_A_ &xout);
+	return;
+
+err:
+	ECHS_ERR_LOG("cannot report back on job %u: %s", jid, STRERR);
+	return;
+}
+
+static void
+xjob_done(EV_P_ uint32_t jid, int st, const struct rusage *ru)
+{
+/* report back to echsd */
+	ECHS_NOTI_LOG("job %u finished with %d", jid, st);
+	xres_put(EV_A_ jid, st, ru);
+	return;
+}
+
+#if defined SYS_pidfd_open && defined SYS_waitid
+/* on linux executors are supervised through pidfds, their exits come in
+ * as readable descriptors and the job id travels with the watcher, so
+ * no SIGCHLD and no pid lookups, only children we couldn't get a pidfd
+ * for go in XPIDS and are reaped the old way */
+# define USE_PIDFD	1
+/* glibc only knows this as idtype_t enum, if at all */
+# define XP_PIDFD	((idtype_t)3)
+
+struct xpfd_s {
+	ev_io w;
+	uint32_t jid;
+};
+
+/* watchers come in pools, free ones are chained through their data */
+#define XPFD_POOL_INIZ	(256U)
+static struct xpfd_s *free_xpfds;
+static struct xpfd_s **xpools;
+static size_t nxpools;
+static size_t zxpools;
+/* watchers in use */
+static size_t nxpfds;
+#else  /* !SYS_pidfd_open || !SYS_waitid */
+# define USE_PIDFD	0
+#endif	/* SYS_pidfd_open && SYS_waitid */
+static bool xpfdp;
+
+static size_t
+xjob_nrun(void)
+{
+#if USE_PIDFD
+	return oidmap_size(xpids) + nxpfds;
+#else  /* !USE_PIDFD */
+	return oidmap_size(xpids);
+#endif	/* USE_PIDFD */
+}
+
+#if USE_PIDFD
+static struct xpfd_s*
+make_xpfd(void)
+{
+	struct xpfd_s *res;
+
+	if (UNLIKELY(free_xpfds == NULL)) {
+		/* chain up another pool */
+		const size_t n = XPFD_POOL_INIZ << nxpools;
+
+		if (nxpools >= zxpools) {
+			const size_t nuz = (zxpools * 2U) ?: 16U;
+			void *nup = realloc(xpools, nuz * sizeof(*xpools));
+
+			if (UNLIKELY(nup == NULL)) {
+				return NULL;
+			}
+			xpools = nup;
+			zxpools = nuz;
+		}
+		if (UNLIKELY((res = malloc(n * sizeof(*res))) == NULL)) {
+			return NULL;
+		}
+		res[n - 1U].w.data = NULL;
+		for (size_t i = n - 1U; i > 0U; i--) {
+			res[i - 1U].w.data = res + i;
+		}
+		xpools[nxpools++] = free_xpfds = res;
+	}
+	/* pop off the free list */
+	res = free_xpfds;
+	free_xpfds = res->w.data;
+	nxpfds++;
+	return res;
+}
+
+static void
+free_xpfd(struct xpfd_s *x)
+{
+	x->w.data = free_xpfds;
+	free_xpfds = x;
+	nxpfds--;
+	return;
+}
+
+static void
+free_xpools(void)
+{
+	for (size_t i = 0U; i < nxpools; i++) {
+		free(xpools[i]);
+	}
+	free(xpools);
+	xpools = NULL;
+	nxpools = zxpools = 0U;
+	free_xpfds = NULL;
+	return;
+}
+
+static int
+si_wstatus(const siginfo_t *si)
+{
+/* turn waitid() findings back into a wait status */
+	switch (si->si_code) {
+	case CLD_EXITED:
+		return (si->si_status & 0xff) << 8;
+	case CLD_DUMPED:
+		return (si->si_status & 0x7f) | 0x80;
+	default:
+		return si->si_status & 0x7f;
+	}
+}
+
+static void
+xpfd_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+	struct xpfd_s *x = (void*)w;
+	struct rusage ru;
+	siginfo_t si;
+
+	si.si_pid = 0;
+	if (syscall(SYS_waitid, XP_PIDFD, w->fd, &si,
+		    WEXITED | WNOHANG, &ru) < 0) {
+		if (errno == EINTR) {
+			return;
+		}
+		/* can't have it go round in circles */
+		ECHS_ERR_LOG("cannot reap job %u: %s", x->jid, STRERR);
+		xjob_done(EV_A_ x->jid, 127 << 8, NULL);
+	} else if (UNLIKELY(!si.si_pid)) {
+		/* not quite dead yet */
+		return;
+	} else {
+		xjob_done(EV_A_ x->jid, si_wstatus(&si), &ru);
+	}
+	ev_io_stop(EV_A_ w);
+	close(w->fd);
+	free_xpfd(x);
+
+	if (!ev_is_active(&xsrv) && !xjob_nrun()) {
+		ev_break(EV_A_ EVBREAK_ALL);
+	}
+	return;
+}
+
+static int
+xpfd_watch(EV_P_ pid_t p, uint32_t jid)
+{
+	struct xpfd_s *x;
+	int fd;
+
+	if (!xpfdp) {
 		return -1;
-	case 0:
-		/* i am the child */
+	} else if ((fd = syscall(SYS_pidfd_open, p, 0)) < 0) {
+		/* out of descriptors probably */
+		return -1;
+	} else if (UNLIKELY((x = make_xpfd()) == NULL)) {
+		close(fd);
+		return -1;
+	}
+	x->jid = jid;
+	ev_io_init(&x->w, xpfd_cb, fd, EV_READ);
+	ev_io_start(EV_A_ &x->w);
+	return 0;
+}
+#else  /* !USE_PIDFD */
+static inline int
+xpfd_watch(EV_P_ pid_t UNUSED(p), uint32_t UNUSED(jid))
+{
+	return -1;
+}
+#endif	/* USE_PIDFD */
+
+static void
+xchld_reap(EV_P)
+{
+/* reap the children in XPIDS */
+	size_t n = 0U;
+
+	if (!oidmap_size(xpids)) {
+		return;
+	}
+	with (echs_oid_t ps[oidmap_size(xpids)]) {
+		oidmap_iter_t i = 0U;
+
+		for (echs_oid_t p; oidmap_next(&i, xpids, &p) != NULL;) {
+			ps[n++] = p;
+		}
+		for (size_t k = 0U; k < n; k++) {
+			struct rusage ru;
+			int st;
+
+			if (wait4(ps[k], &st, WNOHANG, &ru) > 0) {
+				const void *jp = oidmap_del(xpids, ps[k]);
+
+				xjob_done(EV_A_ (uintptr_t)jp, st, &ru);
+			}
+		}
+	}
+	return;
+}
+
+static void
+xsrv_cb(EV_P_ ev_io *w, int UNUSED(revents))
+{
+	static char buf[XJOB_MAXZ];
+	struct xjob_s j;
+	echs_task_t t;
+	ssize_t nrd;
+	bool jlogp;
+	pid_t p;
+	int jfd;
+	int rc;
+
+	if ((nrd = xjob_recv(w->fd, &j, buf, sizeof(buf), &jfd)) < 0) {
+		if (errno == EINTR || errno == EAGAIN) {
+			/* nothing there after all */
+			return;
+		} else if (errno == EMSGSIZE) {
+			/* try the next one */
+			ECHS_ERR_LOG("cannot receive job: %s", STRERR);
+			return;
+		}
+		goto hup;
+	} else if (nrd == 0) {
+		goto hup;
+	} else if (UNLIKELY((t = xjob_task(buf, nrd)) == NULL)) {
+		ECHS_ERR_LOG("\
+cannot execute job %u: no instructions given", j.jid);
+		/* fake the exit status of a failed executor */
+		xres_put(EV_A_ j.jid, 127 << 8, NULL);
+		goto clo;
+	}
+	/* the journal goes to the batches, executors send us records */
+	jlogp = jfd >= 0 && !(jbat_put(j.uid, jfd) < 0);
+	jfd = -1;
+
+	switch ((p = fork())) {
+	case -1:
+		ECHS_ERR_LOG("cannot fork executor for job %u: %s", j.jid, STRERR);
+		xres_put(EV_A_ j.jid, 127 << 8, NULL);
 		break;
+	case 0:
+		/* i am the executor, leave the server loop and its signals
+		 * alone so run_task() can have a default loop of its own */
+		ev_signal_stop(EV_A_ &xchld);
+		close(w->fd);
+		close(xlog[0U]);
+		if (jlogp) {
+			xlog_fd = xlog[1U];
+			xlog_uid = j.uid;
+		} else {
+			/* nowhere to journal to */
+			argi->vjournal_flag = 0;
+		}
+		argi->no_run_flag = j.flags & XJOB_NORUN;
+		rc = echsx(t);
+		_exit(rc < 0 ? 127 : rc);
 	default:
-		/* i am the parent */
-		exit(0);
+		/* i am the server */
+		if (xpfd_watch(EV_A_ p, j.jid) >= 0) {
+			/* supervised by pidfd */
+			;
+		} else if (UNLIKELY(oidmap_put(xpids, p,
+					       (void*)(uintptr_t)j.jid) < 0)) {
+			ECHS_ERR_LOG("\
+cannot keep track of job %u, no report will be sent", j.jid);
+		}
+		break;
+	}
+	free_echs_task(t);
+clo:
+	if (jfd >= 0) {
+		close(jfd);
+	}
+	return;
+
+hup:
+	/* echsd hung up on us, finish what we've got and go */
+	ev_io_stop(EV_A_ w);
+	if (!xjob_nrun()) {
+		ev_break(EV_A_ EVBREAK_ALL);
+	}
+	return;
+}
+
+static void
+xchld_cb(EV_P_ ev_signal *UNUSED(w), int UNUSED(revents))
+{
+	struct rusage ru;
+	pid_t p;
+	int st;
+
+	if (xpfdp) {
+		/* only those without pidfd are ours to reap, a wait4(-1)
+		 * would steal the others from their watchers */
+		xchld_reap(EV_A);
+		goto out;
+	}
+	while ((p = wait4(-1, &st, WNOHANG, &ru)) > 0) {
+		/* job ids are never 0 so a NULL means not one of ours */
+		const void *jp = oidmap_del(xpids, p);
+		const uint32_t jid = (uintptr_t)jp;
+
+		if (UNLIKELY(!jid)) {
+			continue;
+		}
+		xjob_done(EV_A_ jid, st, &ru);
+	}
+out:
+	if (!ev_is_active(&xsrv) && !xjob_nrun()) {
+		ev_break(EV_A_ EVBREAK_ALL);
+	}
+	return;
+}
+
+static int
+xserve(int s)
+{
+/* the server doesn't use the default loop, it reaps its children
+ * itself (to get their resource usage) and the executors need the
+ * default loop to supervise the actual job */
+	EV_P = ev_loop_new(EVFLAG_AUTO);
+
+	if (UNLIKELY(EV_A == NULL)) {
+		return -1;
+	} else if (UNLIKELY((xpids = make_oidmap(64U)) == NULL)) {
+		ev_loop_destroy(EV_A);
+		return -1;
+	} else if (UNLIKELY(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, xlog) < 0)) {
+		free_oidmap(xpids);
+		ev_loop_destroy(EV_A);
+		return -1;
+	}
+	(void)fd_cloexec(xlog[0U]);
+	(void)fd_cloexec(xlog[1U]);
+#if USE_PIDFD
+	/* see if the kernel does pidfds */
+	with (int fd = syscall(SYS_pidfd_open, getpid(), 0)) {
+		if ((xpfdp = fd >= 0)) {
+			close(fd);
+		}
 	}
-	return setsid();
+#endif	/* USE_PIDFD */
+
+	ev_signal_init(&xchld, xchld_cb, SIGCHLD);
+	ev_signal_start(EV_A_ &xchld);
+	/* neither end may block, see xres_put() */
+	(void)fcntl(s, F_SETFL, O_NONBLOCK);
+	ev_io_init(&xsrv, xsrv_cb, s, EV_READ);
+	ev_io_start(EV_A_ &xsrv);
+	ev_io_init(&xout, xout_cb, s, EV_WRITE);
+	ev_io_init(&xlogw, xlog_cb, xlog[0U], EV_READ);
+	ev_io_start(EV_A_ &xlogw);
+	ev_prepare_init(&xflsh, xflsh_cb);
+	ev_prepare_start(EV_A_ &xflsh);
+
+	ECHS_NOTI_LOG("echsx ready");
+	ev_loop(EV_A_ 0);
+
+	/* executors are gone, so are their records, maybe unread though */
+	xlog_cb(EV_A_ &xlogw, EV_READ);
+	ev_prepare_stop(EV_A_ &xflsh);
+	ev_io_stop(EV_A_ &xlogw);
+	ev_signal_stop(EV_A_ &xchld);
+	ev_io_stop(EV_A_ &xout);
+	ev_io_stop(EV_A_ &xsrv);
+	ev_loop_destroy(EV_A);
+	free_oidmap(xpids);
+	free(xress);
+#if USE_PIDFD
+	free_xpools();
+#endif	/* USE_PIDFD */
+	free_jbats();
+	close(xlog[0U]);
+	close(xlog[1U]);
+	return 0;
 }
 
 int
@@ -1424,15 +2131,20 @@ main(int argc, char *argv[])
 
 	if (!argi->daemon_flag) {
 		echs_log = echs_errlog;
-	} else if (daemonise() < 0) {
-		perror("Error: daemonisation failed");
-		rc = 1;
-		goto out;
 	}
 
 	/* start them log files */
 	echs_openlog();
 
+	if (argi->daemon_flag) {
+		/* serve job frames until echsd hangs up */
+		if (xserve(STDIN_FILENO) < 0) {
+			ECHS_ERR_LOG("cannot set up job server: %s", STRERR);
+			rc = 1;
+		}
+		goto clo;
+	}
+
 	with (ical_parser_t pp = NULL) {
 		char buf[4096U];
 		ssize_t nrd;
@@ -1486,6 +2198,7 @@ cannot execute: no uid present");
 		}
 	}
 
+clo:
 	/* stop them log files */
 	echs_closelog();
 
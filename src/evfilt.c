@@ -65,12 +65,14 @@ static echs_event_t next_evfilt(echs_evstrm_t, bool);
 static void free_evfilt(echs_evstrm_t);
 static echs_evstrm_t clone_evfilt(echs_const_evstrm_t);
 static void send_evfilt(int whither, echs_const_evstrm_t s);
+static void seek_evfilt(echs_evstrm_t, echs_instant_t);
 
 static const struct echs_evstrm_class_s evfilt_cls = {
 	.next = next_evfilt,
 	.free = free_evfilt,
 	.clone = clone_evfilt,
 	.seria = send_evfilt,
+	.seek = seek_evfilt,
 };
 
 static echs_event_t
@@ -136,6 +138,16 @@ clone_evfilt(echs_const_evstrm_t s)
 	return (echs_evstrm_t)this;
 }
 
+static void
+seek_evfilt(echs_evstrm_t s, echs_instant_t to)
+{
+/* exceptions are caught up with lazily by next_evfilt() */
+	struct evfilt_s *this = (struct evfilt_s*)s;
+
+	echs_evstrm_seek(this->e, to);
+	return;
+}
+
 static void
 send_evfilt(int whither, echs_const_evstrm_t s)
 {
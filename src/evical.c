@@ -56,6 +56,8 @@
 #include "evrrul.h"
 #include "evmrul.h"
 #include "evfilt.h"
+#include "evsplay.h"
+#include "oidmap.h"
 #include "nifty.h"
 #include "evical-gp.c"
 #include "evrrul-gp.c"
@@ -124,6 +126,8 @@ struct ical_vevent_s {
 
 	/* just to transport the method specified */
 	ical_meth_t meth;
+	/* number of tasks announced for bulk submission, or 0 */
+	size_t nbulk;
 	/* request status or other status info */
 	unsigned int req_status;
 
@@ -160,6 +164,13 @@ struct cal_addr_s {
 	size_t z;
 };
 
+/* anything later than a day isn't slack anymore */
+#define MAX_SLACK	(86400L)
+/* runs may be splayed over a day at most */
+#define MAX_SPLAY	(86400L)
+/* run queue priorities go either way */
+#define MAX_PRIO	(127L)
+
 
 #define CHECK_RESIZE(o, id, iniz, nitems)				\
 	if (UNLIKELY(!(o)->z##id)) {					\
@@ -1022,6 +1033,48 @@ snarf_fld(struct ical_vevent_s ve[static 1U],
 		}
 		break;
 
+	case FLD_SLACK:
+		with (long int i = strtol(vp, &on, 10)) {
+			if (UNLIKELY(on < ep)) {
+				/* couldn't read it */
+				;
+			} else if (UNLIKELY(i < 0 || i > MAX_SLACK)) {
+				/* can't use that value, can we? */
+				;
+			} else {
+				ve->t.slack = i;
+			}
+		}
+		break;
+
+	case FLD_PRIO:
+		with (long int i = strtol(vp, &on, 10)) {
+			if (UNLIKELY(on < ep)) {
+				/* couldn't read it */
+				;
+			} else if (UNLIKELY(i < -MAX_PRIO || i > MAX_PRIO)) {
+				/* can't use that value, can we? */
+				;
+			} else {
+				ve->t.prio = i;
+			}
+		}
+		break;
+
+	case FLD_SPLAY:
+		with (echs_idiff_t i = idiff_strp(vp, &on, ep - vp)) {
+			if (UNLIKELY(on < ep)) {
+				/* couldn't read it */
+				;
+			} else if (UNLIKELY(i.d < 0 || i.d > MAX_SPLAY * 1000)) {
+				/* can't use that value, can we? */
+				;
+			} else {
+				ve->t.splay = i.d / 1000;
+			}
+		}
+		break;
+
 	case FLD_UMASK:
 		with (long int i = strtol(vp, &on, 8)) {
 			if (UNLIKELY(on < ep)) {
@@ -1142,6 +1195,59 @@ snarf_pro(struct ical_vevent_s ve[static 1U],
 		}
 		break;
 
+	case FLD_SLACK:
+		with (long int i = strtol(vp, &on, 10)) {
+			if (UNLIKELY(on < ep)) {
+				/* couldn't read it */
+				;
+			} else if (UNLIKELY(i < 0 || i > MAX_SLACK)) {
+				/* can't use that value, can we? */
+				;
+			} else {
+				ve->t.slack = i;
+			}
+		}
+		break;
+
+	case FLD_PRIO:
+		with (long int i = strtol(vp, &on, 10)) {
+			if (UNLIKELY(on < ep)) {
+				/* couldn't read it */
+				;
+			} else if (UNLIKELY(i < -MAX_PRIO || i > MAX_PRIO)) {
+				/* can't use that value, can we? */
+				;
+			} else {
+				ve->t.prio = i;
+			}
+		}
+		break;
+
+	case FLD_SPLAY:
+		with (echs_idiff_t i = idiff_strp(vp, &on, ep - vp)) {
+			if (UNLIKELY(on < ep)) {
+				/* couldn't read it */
+				;
+			} else if (UNLIKELY(i.d < 0 || i.d > MAX_SPLAY * 1000)) {
+				/* can't use that value, can we? */
+				;
+			} else {
+				ve->t.splay = i.d / 1000;
+			}
+		}
+		break;
+
+	case FLD_BULK:
+		with (unsigned long int n = strtoul(vp, &on, 10)) {
+			if (UNLIKELY(on < ep)) {
+				/* that's no count */
+				;
+			} else {
+				ve->nbulk = n;
+			}
+		}
+		break;
+
 	case FLD_OWNER:
 	case FLD_UMASK:
 	case FLD_SUID:
@@ -1444,6 +1550,18 @@ _ical_proc(struct ical_parser_s p[static 1U])
 				/* bang umask */
 				p->ve.t.max_simul = p->globve.t.max_simul;
 			}
+			if (!p->ve.t.slack) {
+				/* bang slack */
+				p->ve.t.slack = p->globve.t.slack;
+			}
+			if (!p->ve.t.prio) {
+				/* bang priority */
+				p->ve.t.prio = p->globve.t.prio;
+			}
+			if (!p->ve.t.splay) {
+				/* bang splay */
+				p->ve.t.splay = p->globve.t.splay;
+			}
 			if (!p->ve.t.run_as.u) {
 				/* bang run_as */
 				p->ve.t.run_as = p->globve.t.run_as;
@@ -1675,6 +1793,21 @@ send_task(int whither, echs_task_t t)
 	if (t->max_simul < 077U) {
 		fdprintf("X-ECHS-MAX-SIMUL:%d\n", t->max_simul);
 	}
+	if (t->slack) {
+		fdprintf("X-ECHS-SLACK:%u\n", t->slack);
+	}
+	if (t->prio) {
+		fdprintf("X-ECHS-PRIORITY:%d\n", t->prio);
+	}
+	if (t->splay) {
+		char stmp[32U] = "X-ECHS-SPLAY:";
+		size_t n = strlenof("X-ECHS-SPLAY:");
+		const echs_idiff_t i = {(int64_t)t->splay * 1000};
+
+		n += idiff_strf(stmp + n, sizeof(stmp) - n, i);
+		stmp[n++] = '\n';
+		fdwrite(stmp, n);
+	}
 	return;
 }
 
@@ -2039,12 +2172,14 @@ static echs_event_t next_evical_vevent(echs_evstrm_t, bool popp);
 static void free_evical_vevent(echs_evstrm_t);
 static echs_evstrm_t clone_evical_vevent(echs_const_evstrm_t);
 static void send_evical_vevent(int whither, echs_const_evstrm_t s);
+static void seek_evical_vevent(echs_evstrm_t, echs_instant_t);
 
 static const struct echs_evstrm_class_s evical_cls = {
 	.next = next_evical_vevent,
 	.free = free_evical_vevent,
 	.clone = clone_evical_vevent,
 	.seria = send_evical_vevent,
+	.seek = seek_evical_vevent,
 };
 
 static const echs_event_t nul;
@@ -2101,6 +2236,27 @@ next_evical_vevent(echs_evstrm_t s, bool popp)
 	return res;
 }
 
+static void
+seek_evical_vevent(echs_evstrm_t s, echs_instant_t to)
+{
+/* events are sorted, bisect for the first one not before TO */
+	struct evical_s *this = (struct evical_s*)s;
+	size_t lo = this->i;
+	size_t hi = this->nev;
+
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2U;
+
+		if (echs_instant_lt_p(this->ev[mid].from, to)) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	this->i = lo;
+	return;
+}
+
 static void
 send_evical_vevent(int whither, echs_const_evstrm_t s)
 {
@@ -2241,12 +2397,14 @@ static echs_event_t next_evrrul(echs_evstrm_t, bool popp);
 static void free_evrrul(echs_evstrm_t);
 static echs_evstrm_t clone_evrrul(echs_const_evstrm_t);
 static void send_evrrul(int whither, echs_const_evstrm_t s);
+static void seek_evrrul(echs_evstrm_t, echs_instant_t);
 
 static const struct echs_evstrm_class_s evrrul_cls = {
 	.next = next_evrrul,
 	.free = free_evrrul,
 	.clone = clone_evrrul,
 	.seria = send_evrrul,
+	.seek = seek_evrrul,
 };
 
 static echs_evstrm_t
@@ -2434,6 +2592,135 @@ nul:
 	return nul;
 }
 
+static echs_idiff_t
+jump_ival(const struct evrrul_s *strm)
+{
+/* return the interval between consecutive recurrences if there's
+ * exactly one per period, or the nul interval if we can't tell */
+	const struct rrulsp_s *rr = &strm->rrul;
+	int64_t ival;
+
+	if (rr->scale != SCALE_GREGORIAN || strm->cal != SCALE_GREGORIAN) {
+		return echs_nul_idiff();
+	} else if (bi31_has_bits_p(rr->dom) ||
+		   bi383_has_bits_p(&rr->doy) ||
+		   bi447_has_bits_p(&rr->dow) ||
+		   bui31_has_bits_p(rr->mon) ||
+		   bi63_has_bits_p(rr->wk) ||
+		   bui31_has_bits_p(rr->H) ||
+		   bui63_has_bits_p(rr->M) ||
+		   bui63_has_bits_p(rr->S) ||
+		   bi383_has_bits_p(&rr->pos) ||
+		   bi383_has_bits_p(&rr->easter) ||
+		   bi383_has_bits_p(&rr->add)) {
+		/* expansions or filters, no way of telling */
+		return echs_nul_idiff();
+	}
+
+	switch (rr->freq) {
+	case FREQ_WEEKLY:
+		ival = 7 * 86400;
+		break;
+	case FREQ_DAILY:
+		ival = 86400;
+		break;
+	case FREQ_HOURLY:
+		ival = 3600;
+		break;
+	case FREQ_MINUTELY:
+		ival = 60;
+		break;
+	case FREQ_SECONDLY:
+		ival = 1;
+		break;
+	default:
+		/* months and years are too irregular */
+		return echs_nul_idiff();
+	}
+	if (echs_instant_all_day_p(strm->e.from) && ival < 86400) {
+		/* we'd be mixing all-day and intraday instants */
+		return echs_nul_idiff();
+	}
+	return (echs_idiff_t){ival * 1000 * (rr->inter ?: 1U)};
+}
+
+static void
+jump_evrrul(struct evrrul_s *restrict strm, echs_instant_t to)
+{
+/* move the proto instant of STRM (the next one to be generated by
+ * refill()) forward by a whole number of intervals so that it's
+ * still before TO, and account for the skipped ones in COUNT */
+	struct rrulsp_s *restrict rr = &strm->rrul;
+	echs_idiff_t ival;
+	int64_t d;
+	int64_t k;
+
+	if (UNLIKELY(echs_nul_instant_p(strm->e.from))) {
+		return;
+	} else if (!echs_instant_lt_p(strm->e.from, to)) {
+		return;
+	} else if (echs_nul_idiff_p(ival = jump_ival(strm))) {
+		return;
+	}
+	/* do the arithmetic on midnights for all-day instants */
+	with (echs_instant_t from = strm->e.from) {
+		if (echs_instant_all_day_p(from)) {
+			from.H = from.M = from.S = from.ms = 0U;
+		}
+		if (echs_instant_all_day_p(to)) {
+			to.H = to.M = to.S = to.ms = 0U;
+		}
+		d = echs_instant_diff(to, from).d;
+	}
+	if (strm->zon) {
+		/* cached instants get shifted around by the zone offset
+		 * after generation, leave a day's worth of slack */
+		d -= 86400 * 1000;
+	}
+	if ((k = d / ival.d) <= 0) {
+		return;
+	} else if (rr->count > 0 && k >= rr->count) {
+		/* we'd be running out before TO */
+		rr->count = 0;
+		return;
+	} else if (rr->count > 0) {
+		rr->count -= (int)k;
+	}
+	strm->e.from = echs_instant_add(strm->e.from, (echs_idiff_t){k * ival.d});
+	return;
+}
+
+static void
+seek_evrrul(echs_evstrm_t s, echs_instant_t to)
+{
+	struct evrrul_s *restrict this = (struct evrrul_s*)s;
+	size_t lo, hi;
+
+	/* skip whole cache lines, jumping ahead whenever possible */
+	while (this->rdi >= this->ncch ||
+	       echs_instant_lt_p(this->cch[this->ncch - 1U], to)) {
+		this->rdi = this->ncch = 0U;
+		jump_evrrul(this, to);
+		if (refill(this) == 0UL) {
+			/* stream's finished */
+			this->rdi = this->ncch = 0U;
+			return;
+		}
+	}
+	/* bisect the rest */
+	for (lo = this->rdi, hi = this->ncch; lo < hi;) {
+		const size_t mid = lo + (hi - lo) / 2U;
+
+		if (echs_instant_lt_p(this->cch[mid], to)) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	this->rdi = lo;
+	return;
+}
+
 static void
 send_evrrul(int whither, echs_const_evstrm_t s)
 {
@@ -2665,6 +2952,8 @@ make_task(struct ical_vevent_s *ve)
 		 * stream, and SR is known to be a */
 		s = make_evfilt(sr, sx);
 	}
+	/* shift the lot, if asked to */
+	s = make_evsplay(s, ve->t.oid, ve->t.splay);
 	/* now massage the task specific fields in VE into an echs_task_t */
 	*res = ve->t;
 	res->strm = s;
@@ -2752,6 +3041,66 @@ echs_evical_pull(ical_parser_t p[static 1U])
 	return i;
 }
 
+size_t
+echs_evical_bulk(ical_parser_t p[static 1U])
+{
+	const struct ical_parser_s *_p = *p;
+
+	if (UNLIKELY(_p == NULL)) {
+		return 0U;
+	}
+	return _p->globve.nbulk;
+}
+
+size_t
+echs_evical_fold(echs_instruc_t *ins, size_t n)
+{
+	/* oid -> 1 + index of the last cancel not yet followed by a sche */
+	oidmap_t unsc;
+	size_t res = 0U;
+
+	if (UNLIKELY((unsc = make_oidmap(n)) == NULL)) {
+		return (size_t)-1;
+	}
+	for (size_t i = 0U; i < n; i++) {
+		echs_toid_t o;
+		void *j;
+
+		switch (ins[i].v) {
+		case INSVERB_UNSC:
+			if (oidmap_get(unsc, ins[i].o) != NULL) {
+				/* cancelled already */
+				ins[i].v = INSVERB_UNK;
+				res++;
+				break;
+			}
+			if (UNLIKELY(oidmap_put(unsc, ins[i].o,
+						(void*)(i + 1U)) < 0)) {
+				/* can't vouch for anything then */
+				res = (size_t)-1;
+				goto out;
+			}
+			break;
+		case INSVERB_SCHE:
+			if (UNLIKELY(ins[i].t == NULL)) {
+				break;
+			} else if (!(o = ins[i].t->oid)) {
+				break;
+			} else if ((j = oidmap_del(unsc, o)) == NULL) {
+				break;
+			}
+			ins[(uintptr_t)j - 1U].v = INSVERB_UNK;
+			res++;
+			break;
+		default:
+			break;
+		}
+	}
+out:
+	free_oidmap(unsc);
+	return res;
+}
+
 echs_instruc_t
 echs_evical_last_pull(ical_parser_t p[static 1U])
 {
@@ -2852,6 +3201,17 @@ CALSCALE:GREGORIAN\n";
 	return;
 }
 
+void
+echs_icalify_bulk(int whither, size_t n)
+{
+	/* tell the bufferer we want to write to WHITHER */
+	fdbang(whither);
+	fdprintf("X-ECHS-BULK:%zu\n", n);
+	/* the tasks may come from elsewhere, so send this off now */
+	fdflush();
+	return;
+}
+
 void
 echs_icalify_fini(int whither)
 {
@@ -73,6 +73,11 @@ extern void echs_unsc_icalify(int whither, const char *tuid);
  * Send the ical header along with a method and other fields. */
 extern void echs_icalify_init(int whither, echs_instruc_t i);
 
+/**
+ * Announce N tasks to be submitted as a whole, to be called after
+ * `echs_icalify_init()'.  Unlike the init routine this one flushes. */
+extern void echs_icalify_bulk(int whither, size_t n);
+
 /**
  * Send the ical footer. */
 extern void echs_icalify_fini(int whither);
@@ -92,6 +97,21 @@ echs_evical_push(ical_parser_t p[static 1U], const char *buf, size_t bsz);
  * indicating that more data needs to be pushed. */
 extern echs_instruc_t echs_evical_pull(ical_parser_t p[static 1U]);
 
+/**
+ * Return the number of tasks announced (via X-ECHS-BULK) for the
+ * calendar currently parsed by P, or 0 if the calendar is not meant
+ * to be applied as a whole. */
+extern size_t echs_evical_bulk(ical_parser_t p[static 1U]);
+
+/**
+ * Fold the N instructions in INS, as pulled for a bulk submission, so
+ * that they can be applied in order: repeated cancels and cancels
+ * followed by a schedule of the same task are turned into INSVERB_UNK,
+ * the schedule replaces the task anyway.
+ * Return the number of instructions folded, or (size_t)-1 if INS
+ * couldn't be folded, in which case it mustn't be applied. */
+extern size_t echs_evical_fold(echs_instruc_t *ins, size_t n);
+
 /**
  * Indicate that this will be the last pull. */
 extern echs_instruc_t echs_evical_last_pull(ical_parser_t p[static 1U]);
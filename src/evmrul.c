@@ -113,12 +113,14 @@ static echs_event_t next_evmrul_futu(echs_evstrm_t, bool popp);
 static void free_evmrul(echs_evstrm_t);
 static echs_evstrm_t clone_evmrul(echs_const_evstrm_t);
 static void send_evmrul(int, echs_const_evstrm_t);
+static void seek_evmrul_past(echs_evstrm_t, echs_instant_t);
 
 static const struct echs_evstrm_class_s evmrul_past_cls = {
 	.next = next_evmrul_past,
 	.free = free_evmrul,
 	.clone = clone_evmrul,
 	.seria = send_evmrul,
+	.seek = seek_evmrul_past,
 };
 
 static const struct echs_evstrm_class_s evmrul_futu_cls = {
@@ -201,6 +203,20 @@ pop:
 	return res;
 }
 
+static void
+seek_evmrul_past(echs_evstrm_t s, echs_instant_t to)
+{
+/* past movers only ever move backwards in time, so movers before TO
+ * will end up before TO, skip those wholesale, those that begin
+ * after TO might still be moved before it, hence the unwinding.
+ * Future movers can't be skipped like that and use the fallback. */
+	struct evmrul_s *restrict this = (struct evmrul_s*)s;
+
+	echs_evstrm_seek(this->movers, to);
+	echs_evstrm_unwind(s, to);
+	return;
+}
+
 static echs_event_t
 next_evmrul_futu(echs_evstrm_t s, bool popp)
 {
@@ -0,0 +1,166 @@
+/*** evsplay.c -- streams shifted by a stable offset
+ *
+ * Copyright (C) 2014-2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <stdbool.h>
+#include "evsplay.h"
+#include "hash.h"
+#include "tzob.h"
+#include "nifty.h"
+
+/* stream with its events shifted */
+struct evsplay_s {
+	echs_evstrm_class_t class;
+
+	/* the events to shift */
+	echs_evstrm_t s;
+	/* by this much */
+	echs_idiff_t off;
+};
+
+
+static echs_event_t next_evsplay(echs_evstrm_t, bool);
+static void free_evsplay(echs_evstrm_t);
+static echs_evstrm_t clone_evsplay(echs_const_evstrm_t);
+static void send_evsplay(int whither, echs_const_evstrm_t s);
+static void seek_evsplay(echs_evstrm_t, echs_instant_t);
+
+static const struct echs_evstrm_class_s evsplay_cls = {
+	.next = next_evsplay,
+	.free = free_evsplay,
+	.clone = clone_evsplay,
+	.seria = send_evsplay,
+	.seek = seek_evsplay,
+};
+
+static echs_instant_t
+shift(echs_instant_t i, echs_idiff_t off)
+{
+/* shift I by OFF in its own zone */
+	const echs_tzob_t z = echs_instant_tzob(i);
+
+	if (UNLIKELY(echs_nul_instant_p(i) || echs_max_instant_p(i))) {
+		return i;
+	}
+	i = echs_instant_add(echs_instant_detach_tzob(i), off);
+	return echs_instant_attach_tzob(i, z);
+}
+
+static echs_event_t
+next_evsplay(echs_evstrm_t s, bool popp)
+{
+	struct evsplay_s *this = (struct evsplay_s*)s;
+	echs_event_t e = popp
+		? echs_evstrm_pop(this->s) : echs_evstrm_next(this->s);
+
+	e.from = shift(e.from, this->off);
+	return e;
+}
+
+static void
+free_evsplay(echs_evstrm_t s)
+{
+	struct evsplay_s *this = (struct evsplay_s*)s;
+
+	free_echs_evstrm(this->s);
+	free(this);
+	return;
+}
+
+static echs_evstrm_t
+clone_evsplay(echs_const_evstrm_t s)
+{
+	const struct evsplay_s *that = (const struct evsplay_s*)s;
+	struct evsplay_s *this;
+
+	if (UNLIKELY((this = malloc(sizeof(*this))) == NULL)) {
+		return NULL;
+	} else if (UNLIKELY((this->s = clone_echs_evstrm(that->s)) == NULL)) {
+		free(this);
+		return NULL;
+	}
+	this->class = &evsplay_cls;
+	this->off = that->off;
+	return (echs_evstrm_t)this;
+}
+
+static void
+seek_evsplay(echs_evstrm_t s, echs_instant_t to)
+{
+/* events beginning before TO began before TO - OFF originally */
+	struct evsplay_s *this = (struct evsplay_s*)s;
+
+	echs_evstrm_seek(this->s, shift(to, echs_idiff_neg(this->off)));
+	return;
+}
+
+static void
+send_evsplay(int whither, echs_const_evstrm_t s)
+{
+/* the offset is the task's business, serialise the original events */
+	const struct evsplay_s *this = (const struct evsplay_s*)s;
+
+	echs_evstrm_seria(whither, this->s);
+	return;
+}
+
+
+echs_evstrm_t
+make_evsplay(echs_evstrm_t s, echs_oid_t oid, unsigned int splay)
+{
+	struct evsplay_s *res;
+
+	if (UNLIKELY(s == NULL)) {
+		return NULL;
+	} else if (!splay) {
+		/* nothing to shift */
+		return s;
+	} else if (UNLIKELY((res = malloc(sizeof(*res))) == NULL)) {
+		return s;
+	}
+	res->class = &evsplay_cls;
+	res->s = s;
+	/* task oids are the hash of their UIDs, so they're stable across
+	 * processes and we needn't look the name up, which isn't safe
+	 * while the parser threads are interning */
+	res->off = (echs_idiff_t){(int64_t)((hash_t)oid % splay) * 1000};
+	return (echs_evstrm_t)res;
+}
+
+/* evsplay.c ends here */
@@ -59,12 +59,14 @@ static echs_event_t next_evmux(echs_evstrm_t, bool popp);
 static void free_evmux(echs_evstrm_t);
 static echs_evstrm_t clone_evmux(echs_const_evstrm_t);
 static void seria_evmux(int, echs_const_evstrm_t);
+static void seek_evmux(echs_evstrm_t, echs_instant_t);
 
 static const struct echs_evstrm_class_s evmux_cls = {
 	.next = next_evmux,
 	.free = free_evmux,
 	.clone = clone_evmux,
 	.seria = seria_evmux,
+	.seek = seek_evmux,
 };
 
 static void
@@ -141,6 +143,24 @@ next_evmux(echs_evstrm_t strm, bool popp)
 	return best;
 }
 
+static void
+seek_evmux(echs_evstrm_t strm, echs_instant_t to)
+{
+	struct evmux_s *this = (struct evmux_s*)strm;
+
+	if (UNLIKELY(this->s == NULL)) {
+		return;
+	}
+	/* seek all children and recache */
+	for (size_t j = 0UL; j < this->ns; j++) {
+		echs_evstrm_t s = this->s[j];
+
+		echs_evstrm_seek(s, to);
+		this->ev[j] = echs_evstrm_next(s);
+	}
+	return;
+}
+
 static echs_evstrm_t
 make_evmux(echs_evstrm_t s[], size_t ns)
 {
@@ -388,6 +408,18 @@ echs_evstrm_vmux_clon(const echs_evstrm_t s[], size_t n)
 	return make_evmux(strm, nstrm);
 }
 
+void
+echs_evstrm_unwind(echs_evstrm_t s, echs_instant_t to)
+{
+	echs_event_t e;
+
+	while (!echs_event_0_p(e = echs_evstrm_next(s)) &&
+	       echs_instant_lt_p(e.from, to)) {
+		(void)echs_evstrm_pop(s);
+	}
+	return;
+}
+
 size_t
 echs_evstrm_demux(echs_evstrm_t *restrict tgt, size_t tsz,
 		  const struct echs_evstrm_s *s, size_t offset)
@@ -55,6 +55,10 @@ struct echs_evstrm_class_s {
 	void(*free)(echs_evstrm_t);
 	/** serialiser method */
 	void(*seria)(int whither, echs_const_evstrm_t);
+	/** seek method
+	 * pop all events that begin before the instant given,
+	 * optional, see `echs_evstrm_seek()' */
+	void(*seek)(echs_evstrm_t, echs_instant_t);
 };
 
 struct echs_evstrm_s {
@@ -102,6 +106,11 @@ extern size_t
 echs_evstrm_demux(echs_evstrm_t *restrict tgt, size_t tsz,
 		  const struct echs_evstrm_s *s, size_t offset);
 
+/**
+ * Pop events off S one by one until the next one begins at or after TO.
+ * This is the fallback for streams without a seek method. */
+extern void echs_evstrm_unwind(echs_evstrm_t s, echs_instant_t to);
+
 
 static inline echs_event_t
 echs_evstrm_pop(echs_evstrm_t s)
@@ -128,6 +137,15 @@ clone_echs_evstrm(echs_evstrm_t s)
 	return s->class->clone(s);
 }
 
+static inline void
+echs_evstrm_seek(echs_evstrm_t s, echs_instant_t to)
+{
+	if (s->class->seek != NULL) {
+		return s->class->seek(s, to);
+	}
+	return echs_evstrm_unwind(s, to);
+}
+
 static inline void
 echs_evstrm_seria(int whither, echs_evstrm_t s)
 {
@@ -78,8 +78,10 @@ fdprintf(const char *fmt, ...)
 /* like fprintf() (i.e. buffering) but write to FD. */
 	int tp;
 
-	va_list vap;
+	va_list vap, vcp;
 	va_start(vap, fmt);
+	/* the first attempt may use up VAP */
+	va_copy(vcp, vap);
 
 	/* try and write */
 	tp = vsnprintf(
@@ -91,8 +93,9 @@ fdprintf(const char *fmt, ...)
 		/* ... try the formatting again */
 		tp = vsnprintf(
 			fd_aux.buf + fd_aux.bi, sizeof(fd_aux.buf) - fd_aux.bi,
-			fmt, vap);
+			fmt, vcp);
 	}
+	va_end(vcp);
 	va_end(vap);
 
 	/* reassign and out */
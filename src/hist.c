@@ -0,0 +1,112 @@
+/*** hist.c -- log-linear latency histograms
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdint.h>
+#include "hist.h"
+#include "nifty.h"
+
+static inline __attribute__((const)) size_t
+bkt(uint64_t v)
+{
+/* bucket index of V, small values map to themselves, larger ones are
+ * put into sub-bucket (V >> SH) - HIST_SUBB of octave SH + 1 */
+	unsigned int msb;
+	unsigned int sh;
+
+	if (v < HIST_SUBB) {
+		return v;
+	} else if ((msb = 63U - __builtin_clzll(v)) >= HIST_MAXB) {
+		return HIST_NBKT - 1U;
+	}
+	sh = msb - HIST_SUBB_BITS;
+	return (sh + 1U) * HIST_SUBB + ((v >> sh) - HIST_SUBB);
+}
+
+static inline __attribute__((const)) uint64_t
+bkt_max(size_t i)
+{
+/* largest value that goes into bucket I */
+	unsigned int sh;
+
+	if (i < HIST_SUBB) {
+		return i;
+	}
+	sh = i / HIST_SUBB - 1U;
+	return ((uint64_t)(HIST_SUBB + i % HIST_SUBB + 1U) << sh) - 1U;
+}
+
+
+void
+hist_add(struct hist_s *h, uint64_t v)
+{
+	h->b[bkt(v)]++;
+	h->n++;
+	h->sum += v;
+	if (v > h->max) {
+		h->max = v;
+	}
+	return;
+}
+
+uint64_t
+hist_quantile(const struct hist_s *h, double q)
+{
+	uint64_t r;
+	uint64_t c = 0U;
+
+	if (UNLIKELY(!h->n)) {
+		return 0U;
+	} else if (q <= 0) {
+		q = 0;
+	} else if (q >= 1) {
+		return h->max;
+	}
+	/* rank of the value we're after, 1-based */
+	r = (uint64_t)(q * (double)h->n);
+	r += (double)r < q * (double)h->n || !r;
+	for (size_t i = 0U; i < HIST_NBKT; i++) {
+		if ((c += h->b[i]) >= r) {
+			const uint64_t x = bkt_max(i);
+			return x < h->max ? x : h->max;
+		}
+	}
+	return h->max;
+}
+
+/* hist.c ends here */
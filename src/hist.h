@@ -0,0 +1,70 @@
+/*** hist.h -- log-linear latency histograms
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if !defined INCLUDED_hist_h_
+#define INCLUDED_hist_h_
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * HDR-style histograms of non-negative values (microseconds usually).
+ * Buckets are log-linear, every power of 2 is split into HIST_SUBB
+ * equal sub-buckets, so the relative error is bounded by 1/HIST_SUBB.
+ * Values of 2^HIST_MAXB or more end up in the last bucket, the
+ * maximum is kept exactly though. */
+#define HIST_SUBB_BITS	(4U)
+#define HIST_SUBB	(1U << HIST_SUBB_BITS)
+#define HIST_MAXB	(36U)
+#define HIST_NBKT	((HIST_MAXB - HIST_SUBB_BITS + 1U) * HIST_SUBB)
+
+struct hist_s {
+	uint64_t n;
+	uint64_t sum;
+	uint64_t max;
+	uint32_t b[HIST_NBKT];
+};
+
+/**
+ * Record value V in H. */
+extern void hist_add(struct hist_s *h, uint64_t v);
+
+/**
+ * Return the value below which a fraction Q of the values in H fall,
+ * i.e. the upper bound of the bucket that holds the Q-quantile,
+ * clamped to the maximum.  Return 0 if H is empty. */
+extern uint64_t hist_quantile(const struct hist_s *h, double q);
+
+#endif	/* INCLUDED_hist_h_ */
@@ -41,6 +41,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#if defined HAVE_PTHREAD
+# include <pthread.h>
+#endif	/* HAVE_PTHREAD */
 #include "intern.h"
 #include "hash.h"
 #include "nifty.h"
@@ -62,6 +65,16 @@ static size_t obz;
 /* next ob */
 static size_t obn;
 
+#if defined HAVE_PTHREAD
+/* interning may happen in several threads at once */
+static pthread_mutex_t obmtx = PTHREAD_MUTEX_INITIALIZER;
+# define OB_LOCK()	pthread_mutex_lock(&obmtx)
+# define OB_UNLOCK()	pthread_mutex_unlock(&obmtx)
+#else  /* !HAVE_PTHREAD */
+# define OB_LOCK()
+# define OB_UNLOCK()
+#endif	/* HAVE_PTHREAD */
+
 static char
 u2h(uint8_t c)
 {
@@ -123,8 +136,8 @@ make_obint(const char *str, size_t len)
 }
 
 
-obint_t
-intern(const char *str, size_t len)
+static obint_t
+__intern(const char *str, size_t len)
 {
 #define SSTK_NSLOT	(256U)
 #define SSTK_STACK	(4U * SSTK_NSLOT)
@@ -200,6 +213,17 @@ intern(const char *str, size_t len)
 	return 0U;
 }
 
+obint_t
+intern(const char *str, size_t len)
+{
+	obint_t res;
+
+	OB_LOCK();
+	res = __intern(str, len);
+	OB_UNLOCK();
+	return res;
+}
+
 void
 unintern(obint_t UNUSED(ob))
 {
@@ -0,0 +1,292 @@
+/*** oidmap.c -- oid-keyed hash maps
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "oidmap.h"
+#include "nifty.h"
+
+/* maximum probe sequence length before we double the table */
+#define OIDMAP_MAXPSL	(64U)
+#define OIDMAP_INIZ	(16U)
+
+struct cell_s {
+	echs_oid_t oid;
+	void *v;
+};
+
+struct oidmap_s {
+	/* number of cells, always a power of 2 */
+	size_t z;
+	/* number of occupied cells */
+	size_t n;
+	/* number of times we've grown */
+	size_t ngrow;
+	struct cell_s *c;
+};
+
+
+static inline __attribute__((const)) size_t
+mix(echs_oid_t oid)
+{
+/* oids tend to be hashes already but there's no telling which bits
+ * are any good, so scramble them (bijectively) */
+	uint_fast64_t x = oid;
+
+	x ^= x >> 33U;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33U;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33U;
+	return (size_t)x;
+}
+
+static int
+_put(struct cell_s *restrict c, size_t z, struct cell_s *restrict x,
+     size_t maxd)
+{
+/* robin-hood insertion of X into C of size Z,
+ * return 1 if a new cell was occupied, 0 if X's oid was updated and -1
+ * if the probe sequence got longer than MAXD, in which case X holds the
+ * entry that's still homeless */
+	const size_t msk = z - 1U;
+
+	for (size_t i = mix(x->oid) & msk, d = 0U;; i = (i + 1U) & msk, d++) {
+		size_t e;
+
+		if (!c[i].oid) {
+			c[i] = *x;
+			return 1;
+		} else if (c[i].oid == x->oid) {
+			c[i].v = x->v;
+			return 0;
+		} else if (UNLIKELY(d >= maxd)) {
+			return -1;
+		} else if ((e = (i - mix(c[i].oid)) & msk) < d) {
+			/* steal from the rich */
+			struct cell_s tmp = c[i];
+			c[i] = *x;
+			*x = tmp;
+			d = e;
+		}
+	}
+}
+
+static size_t
+_get(const struct oidmap_s *m, echs_oid_t oid)
+{
+/* return the cell index of OID or M->Z if not found */
+	const size_t msk = m->z - 1U;
+
+	for (size_t i = mix(oid) & msk, d = 0U;; i = (i + 1U) & msk, d++) {
+		if (!m->c[i].oid) {
+			break;
+		} else if (m->c[i].oid == oid) {
+			return i;
+		} else if (((i - mix(m->c[i].oid)) & msk) < d) {
+			/* OID would have displaced this one */
+			break;
+		}
+	}
+	return m->z;
+}
+
+static int
+_grow(struct oidmap_s *restrict m, struct cell_s *restrict x)
+{
+/* double M and rehash, then put X (if non-nil),
+ * return -1 on failure or the result of putting X */
+	const size_t nuz = m->z * 2U;
+	struct cell_s *nuc;
+	int rc = 0;
+
+	if (UNLIKELY(nuz < m->z)) {
+		return -1;
+	} else if (UNLIKELY((nuc = calloc(nuz, sizeof(*nuc))) == NULL)) {
+		return -1;
+	}
+	for (size_t i = 0U; i < m->z; i++) {
+		if (m->c[i].oid) {
+			(void)_put(nuc, nuz, m->c + i, -1ULL);
+		}
+	}
+	if (x != NULL) {
+		rc = _put(nuc, nuz, x, -1ULL);
+	}
+	free(m->c);
+	m->c = nuc;
+	m->z = nuz;
+	m->ngrow++;
+	return rc;
+}
+
+
+oidmap_t
+make_oidmap(size_t n)
+{
+	struct oidmap_s *res;
+	size_t z = OIDMAP_INIZ;
+
+	/* find a power of 2 that keeps N below the 3/4 mark */
+	while (z < n + n / 3U + 1U) {
+		z *= 2U;
+	}
+	if (UNLIKELY((res = malloc(sizeof(*res))) == NULL)) {
+		return NULL;
+	} else if (UNLIKELY((res->c = calloc(z, sizeof(*res->c))) == NULL)) {
+		free(res);
+		return NULL;
+	}
+	res->z = z;
+	res->n = 0U;
+	res->ngrow = 0U;
+	return res;
+}
+
+void
+free_oidmap(oidmap_t m)
+{
+	if (UNLIKELY(m == NULL)) {
+		return;
+	}
+	free(m->c);
+	free(m);
+	return;
+}
+
+void*
+oidmap_get(oidmap_t m, echs_oid_t oid)
+{
+	size_t i;
+
+	if (UNLIKELY(!oid)) {
+		return NULL;
+	} else if ((i = _get(m, oid)) >= m->z) {
+		return NULL;
+	}
+	return m->c[i].v;
+}
+
+int
+oidmap_put(oidmap_t m, echs_oid_t oid, void *v)
+{
+	struct cell_s x = {oid, v};
+	int rc;
+
+	if (UNLIKELY(!oid)) {
+		return -1;
+	} else if (UNLIKELY(4U * (m->n + 1U) > 3U * m->z) &&
+		   _get(m, oid) >= m->z && _grow(m, NULL) < 0) {
+		return -1;
+	}
+	if (UNLIKELY((rc = _put(m->c, m->z, &x, OIDMAP_MAXPSL)) < 0)) {
+		/* probe sequences are getting out of hand,
+		 * X now holds whatever got pushed out last */
+		if (UNLIKELY((rc = _grow(m, &x)) < 0)) {
+			/* we've lost an entry, shame */
+			return -1;
+		}
+	}
+	m->n += rc;
+	return 0;
+}
+
+void*
+oidmap_del(oidmap_t m, echs_oid_t oid)
+{
+	const size_t msk = m->z - 1U;
+	void *res;
+	size_t i;
+
+	if (UNLIKELY(!oid)) {
+		return NULL;
+	} else if ((i = _get(m, oid)) >= m->z) {
+		return NULL;
+	}
+	res = m->c[i].v;
+	/* shift the following cells back until we find an empty one
+	 * or one that is home already */
+	for (size_t j = (i + 1U) & msk;
+	     m->c[j].oid && ((j - mix(m->c[j].oid)) & msk);
+	     i = j, j = (j + 1U) & msk) {
+		m->c[i] = m->c[j];
+	}
+	m->c[i] = (struct cell_s){0U, NULL};
+	m->n--;
+	return res;
+}
+
+void
+oidmap_clr(oidmap_t m)
+{
+	memset(m->c, 0, m->z * sizeof(*m->c));
+	m->n = 0U;
+	return;
+}
+
+size_t
+oidmap_size(oidmap_t m)
+{
+	return m->n;
+}
+
+size_t
+oidmap_ngrow(oidmap_t m)
+{
+	return m->ngrow;
+}
+
+void*
+oidmap_next(oidmap_iter_t *i, oidmap_t m, echs_oid_t *oid)
+{
+	for (; *i < m->z; (*i)++) {
+		if (m->c[*i].oid) {
+			const struct cell_s *c = m->c + (*i)++;
+
+			if (oid != NULL) {
+				*oid = c->oid;
+			}
+			return c->v;
+		}
+	}
+	return NULL;
+}
+
+/* oidmap.c ends here */
@@ -0,0 +1,92 @@
+/*** oidmap.h -- oid-keyed hash maps
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if !defined INCLUDED_oidmap_h_
+#define INCLUDED_oidmap_h_
+#include <stddef.h>
+#include "oid.h"
+
+/**
+ * Open-addressing (robin-hood) hash maps from non-0 oids to pointers.
+ * Probe sequences are kept short by displacing richer entries on
+ * insertion and shifting entries back on deletion, so there's no
+ * tombstones.  Maps grow when 3/4 full or when a probe gets too long. */
+typedef struct oidmap_s *oidmap_t;
+
+/**
+ * Iterator type, initialise with 0. */
+typedef size_t oidmap_iter_t;
+
+/**
+ * Return a map with room for at least N entries, or NULL. */
+extern oidmap_t make_oidmap(size_t n);
+
+/**
+ * Free resources associated with map M, values aren't touched. */
+extern void free_oidmap(oidmap_t m);
+
+/**
+ * Return the value associated with OID in M, or NULL if none. */
+extern void *oidmap_get(oidmap_t m, echs_oid_t oid);
+
+/**
+ * Associate OID with V in M, replacing any previous association.
+ * Return 0 on success or -1 if M could not be grown. */
+extern int oidmap_put(oidmap_t m, echs_oid_t oid, void *v);
+
+/**
+ * Remove OID from M and return its previous value, or NULL. */
+extern void *oidmap_del(oidmap_t m, echs_oid_t oid);
+
+/**
+ * Remove all entries from M but keep its size. */
+extern void oidmap_clr(oidmap_t m);
+
+/**
+ * Return the number of entries in M. */
+extern size_t oidmap_size(oidmap_t m);
+
+/**
+ * Return the number of times M had to be grown. */
+extern size_t oidmap_ngrow(oidmap_t m);
+
+/**
+ * Return the next value in M after iterator I and store its oid in OID
+ * unless NULL, or return NULL when there are no more values.
+ * M must not be altered during iteration. */
+extern void *oidmap_next(oidmap_iter_t *i, oidmap_t m, echs_oid_t *oid);
+
+#endif	/* INCLUDED_oidmap_h_ */
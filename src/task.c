@@ -176,4 +176,14 @@ echs_task_rset_ownr(echs_task_t t, unsigned int uid)
 	return 0;
 }
 
+echs_evstrm_t
+echs_task_rset_strm(echs_task_t t, echs_evstrm_t s)
+{
+	struct echs_task_s *restrict tmpt = deconst(t);
+	echs_evstrm_t res = tmpt->strm;
+
+	tmpt->strm = s;
+	return res;
+}
+
 /* task.c ends here */
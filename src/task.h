@@ -131,6 +131,14 @@ struct echs_task_s {
 	/* padding */
 	unsigned int:6U;
 
+	/* number of seconds a run may be late, so its wake-up can be
+	 * shared with other tasks, 0 means be punctual */
+	unsigned int slack;
+	/* when runs have to queue for a free slot, higher ones go first */
+	int prio;
+	/* runs are shifted by a stable offset below this many seconds */
+	unsigned int splay;
+
 	/* due date or timeout value if this is a (non-recurring) VTODO
 	 * (i.e. the STRM slot will be NULL)
 	 * which one it is is determined by VTOD_TYP above */
@@ -154,6 +162,11 @@ extern int echs_task_rset_toid(echs_task_t t, echs_toid_t oid);
  * Negative values of UID `unset' the owner field. */
 extern int echs_task_rset_ownr(echs_task_t t, unsigned int uid);
 
+/**
+ * Forcefully change the event stream of T to S.
+ * The old stream is returned and it is up to the caller to free it. */
+extern echs_evstrm_t echs_task_rset_strm(echs_task_t t, echs_evstrm_t s);
+
 
 /* convenience */
 static inline __attribute__((const, pure)) bool
@@ -0,0 +1,302 @@
+/*** twheel.c -- hierarchical timing wheels
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <stdint.h>
+#include "twheel.h"
+#include "nifty.h"
+
+/* 6 levels of 64 slots each cover 2^36 ticks, that's a good 2000 years
+ * worth of seconds, anything beyond is put on an overflow list */
+#define TW_BITS		(6U)
+#define TW_NSLOT	(1U << TW_BITS)
+#define TW_MASK		(TW_NSLOT - 1U)
+#define TW_NLVL		(6U)
+#define TW_OVFL		(TW_NLVL * TW_NSLOT)
+#define TW_DUE		(TW_OVFL + 1U)
+#define TW_NLST		(TW_DUE + 1U)
+
+struct twheel_s {
+	/* current tick */
+	twtick_t now;
+	/* number of nodes */
+	size_t nn;
+	/* bitsets of occupied slots, per level */
+	uint64_t pend[TW_NLVL];
+	/* list heads, one per slot, then overflow and due */
+	struct twnode_s l[TW_NLST];
+};
+
+
+static inline void
+lst_ini(struct twnode_s *restrict h)
+{
+	h->next = h->prev = h;
+	return;
+}
+
+static inline int
+lst_empty_p(const struct twnode_s *h)
+{
+	return h->next == h;
+}
+
+static inline void
+lst_put(struct twnode_s *restrict h, struct twnode_s *restrict n)
+{
+/* append N to H */
+	n->prev = h->prev;
+	n->next = h;
+	h->prev->next = n;
+	h->prev = n;
+	return;
+}
+
+static inline void
+lst_cut(struct twnode_s *restrict n)
+{
+	n->prev->next = n->next;
+	n->next->prev = n->prev;
+	n->next = n->prev = NULL;
+	return;
+}
+
+static inline void
+lst_cat(struct twnode_s *restrict h, struct twnode_s *restrict o)
+{
+/* move all of O to the end of H */
+	if (lst_empty_p(o)) {
+		return;
+	}
+	o->next->prev = h->prev;
+	h->prev->next = o->next;
+	o->prev->next = h;
+	h->prev = o->prev;
+	lst_ini(o);
+	return;
+}
+
+static void
+_put(struct twheel_s *restrict w, struct twnode_s *restrict n)
+{
+/* put N in the slot corresponding to its expiry relative to the wheel,
+ * nodes sit on the level of the highest digit in which their expiry
+ * and the current tick differ, in the slot of their expiry's digit */
+	unsigned int lst;
+	unsigned int lvl;
+
+	if (n->when <= w->now) {
+		lst = TW_DUE;
+	} else if ((lvl = (63U - __builtin_clzll(n->when ^ w->now)) / TW_BITS) <
+		   TW_NLVL) {
+		const unsigned int s = (n->when >> (lvl * TW_BITS)) & TW_MASK;
+
+		w->pend[lvl] |= 1ULL << s;
+		lst = lvl * TW_NSLOT + s;
+	} else {
+		lst = TW_OVFL;
+	}
+	n->lst = lst;
+	lst_put(w->l + lst, n);
+	return;
+}
+
+
+twheel_t
+make_twheel(twtick_t now)
+{
+	struct twheel_s *res;
+
+	if (UNLIKELY((res = malloc(sizeof(*res))) == NULL)) {
+		return NULL;
+	}
+	res->now = now;
+	res->nn = 0U;
+	for (size_t i = 0U; i < countof(res->pend); i++) {
+		res->pend[i] = 0U;
+	}
+	for (size_t i = 0U; i < countof(res->l); i++) {
+		lst_ini(res->l + i);
+	}
+	return res;
+}
+
+void
+free_twheel(twheel_t w)
+{
+	free(w);
+	return;
+}
+
+void
+twheel_add(twheel_t w, struct twnode_s *n, twtick_t when)
+{
+	twheel_del(w, n);
+	n->when = when;
+	_put(w, n);
+	w->nn++;
+	return;
+}
+
+void
+twheel_del(twheel_t w, struct twnode_s *n)
+{
+	const unsigned int lst = n->lst;
+
+	if (!twnode_linked_p(n)) {
+		return;
+	}
+	lst_cut(n);
+	if (lst < TW_OVFL && lst_empty_p(w->l + lst)) {
+		w->pend[lst / TW_NSLOT] &= ~(1ULL << (lst % TW_NSLOT));
+	}
+	w->nn--;
+	return;
+}
+
+void
+twheel_advance(twheel_t w, twtick_t now)
+{
+	const twtick_t old = w->now;
+	struct twnode_s todo;
+
+	if (UNLIKELY(now <= old)) {
+		return;
+	}
+	lst_ini(&todo);
+	for (unsigned int lvl = 0U; lvl < TW_NLVL; lvl++) {
+		const unsigned int sh = lvl * TW_BITS;
+		const unsigned int od = (old >> sh) & TW_MASK;
+		uint64_t m;
+
+		if ((old >> sh) == (now >> sh)) {
+			/* no boundaries crossed on this level or above */
+			break;
+		} else if ((old >> (sh + TW_BITS)) == (now >> (sh + TW_BITS))) {
+			/* slots between the old and new digit have passed */
+			const unsigned int nd = (now >> sh) & TW_MASK;
+
+			m = ((2ULL << nd) - 1U) & ~((2ULL << od) - 1U);
+		} else {
+			/* we've gone round, every slot after od has passed */
+			m = ~((2ULL << od) - 1U);
+		}
+		for (uint64_t p; (p = w->pend[lvl] & m);) {
+			const unsigned int s = __builtin_ctzll(p);
+
+			lst_cat(&todo, w->l + lvl * TW_NSLOT + s);
+			w->pend[lvl] &= ~(1ULL << s);
+		}
+	}
+	if ((old >> (TW_NLVL * TW_BITS)) != (now >> (TW_NLVL * TW_BITS))) {
+		lst_cat(&todo, w->l + TW_OVFL);
+	}
+	/* reinsert relative to the new tick, cascading them down */
+	w->now = now;
+	while (!lst_empty_p(&todo)) {
+		struct twnode_s *n = todo.next;
+
+		lst_cut(n);
+		_put(w, n);
+	}
+	return;
+}
+
+struct twnode_s*
+twheel_pop(twheel_t w)
+{
+	struct twnode_s *h = w->l + TW_DUE;
+	struct twnode_s *n;
+
+	if (lst_empty_p(h)) {
+		return NULL;
+	}
+	lst_cut(n = h->next);
+	w->nn--;
+	return n;
+}
+
+twtick_t
+twheel_timeout(twheel_t w)
+{
+	twtick_t res = TWHEEL_NEVER;
+
+	if (!lst_empty_p(w->l + TW_DUE)) {
+		return 0U;
+	}
+	for (unsigned int lvl = 0U; lvl < TW_NLVL; lvl++) {
+		const unsigned int sh = lvl * TW_BITS;
+
+		if (w->pend[lvl]) {
+			/* occupied slots are always past the current digit
+			 * so the lowest one is the one to wake up for */
+			const unsigned int s = __builtin_ctzll(w->pend[lvl]);
+			const twtick_t b =
+				(w->now >> (sh + TW_BITS) << (sh + TW_BITS)) +
+				((twtick_t)s << sh);
+
+			if (b - w->now < res) {
+				res = b - w->now;
+			}
+		}
+	}
+	if (!lst_empty_p(w->l + TW_OVFL)) {
+		const unsigned int sh = TW_NLVL * TW_BITS;
+		const twtick_t b = ((w->now >> sh) + 1U) << sh;
+
+		if (b - w->now < res) {
+			res = b - w->now;
+		}
+	}
+	return res;
+}
+
+twtick_t
+twheel_now(twheel_t w)
+{
+	return w->now;
+}
+
+size_t
+twheel_size(twheel_t w)
+{
+	return w->nn;
+}
+
+/* twheel.c ends here */
@@ -0,0 +1,113 @@
+/*** twheel.h -- hierarchical timing wheels
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if !defined INCLUDED_twheel_h_
+#define INCLUDED_twheel_h_
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Timing wheels hold intrusive nodes keyed on an absolute tick count
+ * (seconds usually) and provide O(1) insertion and cancellation.
+ * The wheel only ever moves forward in time, nodes whose ticks have
+ * passed end up on a due list to be popped off by the caller. */
+typedef uint_fast64_t twtick_t;
+typedef struct twheel_s *twheel_t;
+
+#define TWHEEL_NEVER	((twtick_t)-1)
+
+/**
+ * Wheel nodes, to be embedded in the user's objects. */
+struct twnode_s {
+	struct twnode_s *next;
+	struct twnode_s *prev;
+	/* absolute expiry */
+	twtick_t when;
+	/* list we're on, for book-keeping */
+	unsigned int lst;
+};
+
+
+/**
+ * Instantiate a wheel starting at tick NOW. */
+extern twheel_t make_twheel(twtick_t now);
+
+/**
+ * Free resources associated with wheel W.
+ * Nodes still on the wheel are not touched. */
+extern void free_twheel(twheel_t w);
+
+/**
+ * Put node N onto W to expire at WHEN.
+ * If N is already on the wheel it is moved. */
+extern void twheel_add(twheel_t w, struct twnode_s *n, twtick_t when);
+
+/**
+ * Take node N off of W, it is safe to call this on unlinked nodes. */
+extern void twheel_del(twheel_t w, struct twnode_s *n);
+
+/**
+ * Advance W to tick NOW, nodes expiring until NOW are put on the
+ * due list and can be obtained through `twheel_pop()'. */
+extern void twheel_advance(twheel_t w, twtick_t now);
+
+/**
+ * Pop the next due node off of W, or NULL if there's none. */
+extern struct twnode_s *twheel_pop(twheel_t w);
+
+/**
+ * Return the number of ticks after which W wants advancing next,
+ * or TWHEEL_NEVER if W is empty.  This might be earlier than the
+ * next expiry as nodes far in the future need cascading. */
+extern twtick_t twheel_timeout(twheel_t w);
+
+/**
+ * Return W's current tick. */
+extern twtick_t twheel_now(twheel_t w);
+
+/**
+ * Return the number of nodes on W. */
+extern size_t twheel_size(twheel_t w);
+
+
+/* convenience */
+static inline __attribute__((pure)) int
+twnode_linked_p(const struct twnode_s *n)
+{
+	return n->prev != NULL;
+}
+
+#endif	/* INCLUDED_twheel_h_ */
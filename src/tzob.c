@@ -43,6 +43,9 @@
 #include <stdint.h>
 #include <time.h>
 #include <sys/time.h>
+#if defined HAVE_PTHREAD
+# include <pthread.h>
+#endif	/* HAVE_PTHREAD */
 #include "tzob.h"
 #include "tzraw.h"
 #include "hash.h"
@@ -77,6 +80,17 @@ static struct {
 } tmfu[16U];
 static zif_t zmfu[16U];
 
+#if defined HAVE_PTHREAD
+/* the tables above and the zifs (they cache their last range) may be
+ * used from several threads, UTC (tzob 0) never needs any of them */
+static pthread_mutex_t zmtx = PTHREAD_MUTEX_INITIALIZER;
+# define Z_LOCK()	pthread_mutex_lock(&zmtx)
+# define Z_UNLOCK()	pthread_mutex_unlock(&zmtx)
+#else  /* !HAVE_PTHREAD */
+# define Z_LOCK()
+# define Z_UNLOCK()
+#endif	/* HAVE_PTHREAD */
+
 static void*
 recalloc(void *buf, size_t nmemb_ol, size_t nmemb_nu, size_t membz)
 {
@@ -162,10 +176,12 @@ retr_tzob(echs_tzob_t z)
 	return hxa[i - 1U];
 }
 
+static const char *__echs_zone(echs_tzob_t z);
+
 static zif_t
 __tzob_zif(echs_tzob_t zob)
 {
-/* return a zif_t object from ZOB. */
+/* return a zif_t object from ZOB, call with the lock held. */
 #define SWP(x, y)					\
 	do {						\
 		__typeof(x) paste(__tmp, __LINE__) = x;	\
@@ -199,7 +215,7 @@ __tzob_zif(echs_tzob_t zob)
 	if (tmfu[i].z == zob) {
 		/* how lucky can we get? */
 		this = zmfu[i];
-	} else if (UNLIKELY((fn = echs_zone(zob)) == NULL)) {
+	} else if (UNLIKELY((fn = __echs_zone(zob)) == NULL)) {
 		/* yea, bollocks */
 		this = NULL;
 	} else if (UNLIKELY((this = zif_open(fn)) == NULL)) {
@@ -307,8 +323,8 @@ __epoch_to_inst(time_t t)
 }
 
 
-echs_tzob_t
-echs_tzob(const char *str, size_t len)
+static echs_tzob_t
+__echs_tzob(const char *str, size_t len)
 {
 #define SSTK_NSLOT	(256U)
 #define SSTK_STACK	(4U * SSTK_NSLOT)
@@ -386,8 +402,19 @@ echs_tzob(const char *str, size_t len)
 	return 0U;
 }
 
-const char*
-echs_zone(echs_tzob_t z)
+echs_tzob_t
+echs_tzob(const char *str, size_t len)
+{
+	echs_tzob_t res;
+
+	Z_LOCK();
+	res = __echs_tzob(str, len);
+	Z_UNLOCK();
+	return res;
+}
+
+static const char*
+__echs_zone(echs_tzob_t z)
 {
 	hash_t hx;
 	hash_t k;
@@ -433,6 +460,17 @@ yep:
 	return obs + o;
 }
 
+const char*
+echs_zone(echs_tzob_t z)
+{
+	const char *res;
+
+	Z_LOCK();
+	res = __echs_zone(z);
+	Z_UNLOCK();
+	return res;
+}
+
 void
 clear_tzobs(void)
 {
@@ -470,12 +508,19 @@ echs_instant_utc(echs_instant_t i, echs_tzob_t zob)
 	if (UNLIKELY(echs_instant_all_day_p(i))) {
 		/* just do fuckall */
 		;
-	} else if (LIKELY((z = __tzob_zif(zob)) != NULL)) {
-		time_t loc = __inst_to_epoch(i);
-		time_t nix = zif_utc_time(z, loc);
-		echs_idiff_t d = {.d = 1000 * (nix - loc)};
+	} else if (!zob) {
+		/* UTC already */
+		;
+	} else {
+		Z_LOCK();
+		if (LIKELY((z = __tzob_zif(zob)) != NULL)) {
+			time_t loc = __inst_to_epoch(i);
+			time_t nix = zif_utc_time(z, loc);
+			echs_idiff_t d = {.d = 1000 * (nix - loc)};
 
-		i = echs_instant_add(i, d);
+			i = echs_instant_add(i, d);
+		}
+		Z_UNLOCK();
 	}
 	return i;
 }
@@ -489,12 +534,19 @@ echs_instant_loc(echs_instant_t i, echs_tzob_t zob)
 	if (UNLIKELY(echs_instant_all_day_p(i))) {
 		/* just do fuckall */
 		;
-	} else if (LIKELY((z = __tzob_zif(zob)) != NULL)) {
-		time_t nix = __inst_to_epoch(i);
-		time_t loc = zif_local_time(z, nix);
-		echs_idiff_t d = {.d = 1000 * (loc - nix)};
+	} else if (!zob) {
+		/* UTC stays UTC */
+		;
+	} else {
+		Z_LOCK();
+		if (LIKELY((z = __tzob_zif(zob)) != NULL)) {
+			time_t nix = __inst_to_epoch(i);
+			time_t loc = zif_local_time(z, nix);
+			echs_idiff_t d = {.d = 1000 * (loc - nix)};
 
-		i = echs_instant_add(i, d);
+			i = echs_instant_add(i, d);
+		}
+		Z_UNLOCK();
 	}
 	return i;
 }
@@ -502,19 +554,25 @@ echs_instant_loc(echs_instant_t i, echs_tzob_t zob)
 int
 echs_tzob_offs(echs_tzob_t z, echs_instant_t i, int x)
 {
-	time_t nix;
+	int res = 0;
 	zif_t _z;
 
 	i = echs_instant_detach_tzob(i);
 	if (UNLIKELY(echs_instant_all_day_p(i))) {
 		/* nah, all-day shit isn't offset at all */
 		return 0;
-	} else if (UNLIKELY((_z = __tzob_zif(z)) == NULL)) {
+	} else if (!z) {
+		/* UTC has no offset */
 		return 0;
 	}
-	/* just convert the instant now */
-	nix = __inst_to_epoch(i);
-	return zif_find_zrng(_z, nix + x).offs;
+	Z_LOCK();
+	if (LIKELY((_z = __tzob_zif(z)) != NULL)) {
+		/* just convert the instant now */
+		time_t nix = __inst_to_epoch(i);
+		res = zif_find_zrng(_z, nix + x).offs;
+	}
+	Z_UNLOCK();
+	return res;
 }
 
 /* these are borrowed from instant.h, seeing as we've got the routines here */
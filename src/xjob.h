@@ -0,0 +1,206 @@
+/*** xjob.h -- job frames between echsd and echsx
+ *
+ * Copyright (C) 2018 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of echse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if !defined INCLUDED_xjob_h_
+#define INCLUDED_xjob_h_
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/resource.h>
+#include "nifty.h"
+
+#if !defined MSG_NOSIGNAL
+# define MSG_NOSIGNAL	(0)
+#endif	/* !MSG_NOSIGNAL */
+
+/**
+ * Job frame as sent by echsd to a long-running echsx, one frame per
+ * message on a SOCK_SEQPACKET socket.
+ * The header is followed by a VCALENDAR with exactly one VTODO in it,
+ * a descriptor of UID's journal may be passed along (SCM_RIGHTS). */
+struct xjob_s {
+	uint32_t jid;
+	uint32_t flags;
+	uint32_t uid;
+};
+
+/* don't run the job, just file a report saying so */
+#define XJOB_NORUN	(1U)
+
+/* largest VTODO we're prepared to put in a frame */
+#define XJOB_MAXZ	(65536U)
+
+/**
+ * Result frame as sent back by echsx once job JID has finished.
+ * ST is the wait status of the job's executor, RU its resource usage
+ * (including that of the job itself). */
+struct xres_s {
+	uint32_t jid;
+	int st;
+	struct rusage ru;
+};
+
+union xjob_cmsg_u {
+	struct cmsghdr h;
+	char b[CMSG_SPACE(sizeof(int))];
+};
+
+
+static inline ssize_t
+xjob_send(int s, struct xjob_s j, const char *vtod, size_t vtoz, int fd)
+{
+/* send job J along with VTOD (of size VTOZ) and, if non-negative, FD */
+	struct iovec iov[] = {
+		{&j, sizeof(j)},
+		{deconst(vtod), vtoz},
+	};
+	struct msghdr m = {.msg_iov = iov, .msg_iovlen = countof(iov)};
+	union xjob_cmsg_u cm;
+
+	if (fd >= 0) {
+		memset(&cm, 0, sizeof(cm));
+		m.msg_control = cm.b;
+		m.msg_controllen = sizeof(cm.b);
+		cm.h.cmsg_len = CMSG_LEN(sizeof(fd));
+		cm.h.cmsg_level = SOL_SOCKET;
+		cm.h.cmsg_type = SCM_RIGHTS;
+		memcpy(CMSG_DATA(&cm.h), &fd, sizeof(fd));
+	}
+	return sendmsg(s, &m, MSG_NOSIGNAL);
+}
+
+static inline ssize_t
+xjob_recv(int s, struct xjob_s *restrict j,
+	  char *restrict vtod, size_t vtoz, int *restrict fd)
+{
+/* receive a job frame into J and VTOD, return the size of the VTODO
+ * bit, 0 on hang-up and -1 on error.
+ * If a descriptor came along it's put into FD, -1 otherwise. */
+	struct iovec iov[] = {
+		{j, sizeof(*j)},
+		{vtod, vtoz},
+	};
+	union xjob_cmsg_u cm;
+	struct msghdr m = {
+		.msg_iov = iov, .msg_iovlen = countof(iov),
+		.msg_control = cm.b, .msg_controllen = sizeof(cm.b),
+	};
+	ssize_t nrd;
+
+	*fd = -1;
+	if ((nrd = recvmsg(s, &m, 0)) <= 0) {
+		return nrd;
+	}
+	for (struct cmsghdr *c = CMSG_FIRSTHDR(&m);
+	     c != NULL; c = CMSG_NXTHDR(&m, c)) {
+		if (c->cmsg_level == SOL_SOCKET &&
+		    c->cmsg_type == SCM_RIGHTS) {
+			memcpy(fd, CMSG_DATA(c), sizeof(*fd));
+		}
+	}
+	if (UNLIKELY((size_t)nrd < sizeof(*j) ||
+		     m.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+		/* that's no frame of ours */
+		if (*fd >= 0) {
+			close(*fd);
+			*fd = -1;
+		}
+		errno = EMSGSIZE;
+		return -1;
+	}
+	return nrd - sizeof(*j);
+}
+
+static inline ssize_t
+xres_send(int s, uint32_t jid, int st, const struct rusage *ru)
+{
+	struct xres_s r = {.jid = jid, .st = st};
+
+	if (ru != NULL) {
+		r.ru = *ru;
+	}
+	return send(s, &r, sizeof(r), MSG_NOSIGNAL);
+}
+
+
+/**
+ * Journal frame as sent by an echsx executor to its server, the header
+ * is followed by a VTODO to be appended to UID's journal. */
+struct xlog_s {
+	uint32_t uid;
+};
+
+static inline ssize_t
+xlog_send(int s, uint32_t uid, const char *rec, size_t recz)
+{
+	struct xlog_s l = {.uid = uid};
+	struct iovec iov[] = {
+		{&l, sizeof(l)},
+		{deconst(rec), recz},
+	};
+	struct msghdr m = {.msg_iov = iov, .msg_iovlen = countof(iov)};
+
+	return sendmsg(s, &m, MSG_NOSIGNAL);
+}
+
+static inline ssize_t
+xlog_recv(int s, uint32_t *restrict uid, char *restrict rec, size_t recz)
+{
+/* receive a journal frame, put the record into REC and return its size */
+	struct xlog_s l;
+	struct iovec iov[] = {
+		{&l, sizeof(l)},
+		{rec, recz},
+	};
+	struct msghdr m = {.msg_iov = iov, .msg_iovlen = countof(iov)};
+	ssize_t nrd;
+
+	if ((nrd = recvmsg(s, &m, MSG_DONTWAIT)) <= 0) {
+		return nrd;
+	} else if (UNLIKELY((size_t)nrd < sizeof(l) ||
+			    m.msg_flags & MSG_TRUNC)) {
+		errno = EMSGSIZE;
+		return -1;
+	}
+	*uid = l.uid;
+	return nrd - sizeof(l);
+}
+
+#endif	/* INCLUDED_xjob_h_ */
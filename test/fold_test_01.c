@@ -0,0 +1,56 @@
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "evical.h"
+#include "nifty.h"
+
+static struct echs_task_s a = {.oid = 0x1000U};
+static struct echs_task_s b = {.oid = 0x2000U};
+
+#define S(x)	{.v = INSVERB_SCHE, .t = &x}
+#define U(x)	{.v = INSVERB_UNSC, .o = x.oid}
+
+static void
+prnt(const char *nm, echs_instruc_t *ins, size_t n)
+{
+	size_t nf = echs_evical_fold(ins, n);
+
+	printf("%s %zu", nm, nf);
+	for (size_t i = 0U; i < n; i++) {
+		const char *t = "-";
+
+		switch (ins[i].v) {
+		case INSVERB_SCHE:
+			t = ins[i].t == &a ? "Sa" : "Sb";
+			break;
+		case INSVERB_UNSC:
+			t = ins[i].o == a.oid ? "Ua" : "Ub";
+			break;
+		default:
+			break;
+		}
+		printf(" %s", t);
+	}
+	putchar('\n');
+	return;
+}
+
+int
+main(void)
+{
+	echs_instruc_t t1[] = {U(a), S(a)};
+	echs_instruc_t t2[] = {U(a), U(a), S(a)};
+	echs_instruc_t t3[] = {S(a), U(a)};
+	echs_instruc_t t4[] = {U(a), S(b), U(b)};
+	echs_instruc_t t5[] = {U(a), S(a), U(a), S(a)};
+
+	prnt("resched", t1, countof(t1));
+	prnt("repeated", t2, countof(t2));
+	prnt("cancel-last", t3, countof(t3));
+	prnt("others", t4, countof(t4));
+	prnt("twice", t5, countof(t5));
+	return 0;
+}
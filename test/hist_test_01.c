@@ -0,0 +1,56 @@
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdio.h>
+#include <stdint.h>
+#include "hist.h"
+
+static struct hist_s h;
+
+static size_t
+near(uint64_t x, uint64_t exp)
+{
+/* X is right to within a bucket's width */
+	return x < exp || x > exp + exp / HIST_SUBB;
+}
+
+int
+main(void)
+{
+	static const double qs[] = {0.5, 0.9, 0.99, 0.999};
+	size_t nbad = 0U;
+
+	nbad += hist_quantile(&h, 0.5) != 0U;
+	printf("empty %zu\n", nbad);
+
+	/* small values are exact */
+	for (uint64_t v = 0U; v < HIST_SUBB; v++) {
+		hist_add(&h, v);
+	}
+	nbad += hist_quantile(&h, 0.5) != HIST_SUBB / 2U - 1U;
+	nbad += hist_quantile(&h, 1.) != HIST_SUBB - 1U;
+	printf("small %zu\n", nbad);
+
+	/* 1 to 10^6 uniformly */
+	h = (struct hist_s){0U};
+	for (uint64_t v = 1U; v <= 1000000U; v++) {
+		hist_add(&h, v);
+	}
+	for (size_t i = 0U; i < sizeof(qs) / sizeof(*qs); i++) {
+		const uint64_t x = hist_quantile(&h, qs[i]);
+
+		nbad += near(x, (uint64_t)(qs[i] * 1000000.));
+	}
+	nbad += hist_quantile(&h, 1.) != 1000000U;
+	nbad += h.n != 1000000U || h.sum != 500000500000ULL;
+	printf("uniform %zu\n", nbad);
+
+	/* huge values are clamped but the maximum is exact */
+	hist_add(&h, 1ULL << 50U);
+	nbad += h.b[HIST_NBKT - 1U] != 1U;
+	nbad += hist_quantile(&h, 1.) != 1ULL << 50U;
+	printf("huge %zu\n", nbad);
+	return nbad > 0U;
+}
+
+/* hist_test_01.c ends here */
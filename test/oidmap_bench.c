@@ -0,0 +1,94 @@
+/* insert, lookup and erase 1M oids with the oid map, the oids are
+ * picked so that they collide in their low bits, which is what the
+ * old task table in echsd used for indexing, build with
+ * `make oidmap_bench' */
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "oidmap.h"
+
+#define NOIDS	(1000000U)
+
+static double
+cpu(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+static long
+maxrss(void)
+{
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+static echs_oid_t
+oid_hibits(size_t i)
+{
+/* differ only in the high bits */
+	return ((echs_oid_t)(i + 1U) << 32U) | 0xc0ffeeU;
+}
+
+static echs_oid_t
+oid_stride(size_t i)
+{
+/* all multiples of a large power of 2 */
+	return (echs_oid_t)(i + 1U) << 20U;
+}
+
+static echs_oid_t
+oid_seq(size_t i)
+{
+	return (echs_oid_t)(i + 1U);
+}
+
+static void
+bench(const char *name, echs_oid_t(*f)(size_t))
+{
+	oidmap_t m = make_oidmap(0U);
+	size_t nbad = 0U;
+	double c0, c1, c2, c3;
+
+	c0 = cpu();
+	for (size_t i = 0U; i < NOIDS; i++) {
+		nbad += oidmap_put(m, f(i), (void*)(uintptr_t)(i + 1U)) < 0;
+	}
+	c1 = cpu();
+	for (size_t i = 0U; i < NOIDS; i++) {
+		nbad += oidmap_get(m, f(i)) != (void*)(uintptr_t)(i + 1U);
+		nbad += oidmap_get(m, f(i + NOIDS)) != NULL;
+	}
+	c2 = cpu();
+	for (size_t i = 0U; i < NOIDS; i++) {
+		nbad += oidmap_del(m, f(i)) != (void*)(uintptr_t)(i + 1U);
+	}
+	c3 = cpu();
+	printf("%-8s  %8.1f  %8.1f  %8.1f  %10ld  %zu\n", name,
+	       (c1 - c0) / NOIDS * 1000000000,
+	       (c2 - c1) / (2 * NOIDS) * 1000000000,
+	       (c3 - c2) / NOIDS * 1000000000,
+	       maxrss(), nbad);
+	free_oidmap(m);
+	return;
+}
+
+int
+main(void)
+{
+	printf("%-8s  %8s  %8s  %8s  %10s  %s\n",
+	       "oids", "put/ns", "get/ns", "del/ns", "maxrss/kB", "bad");
+	bench("hibits", oid_hibits);
+	bench("stride", oid_stride);
+	bench("seq", oid_seq);
+	return 0;
+}
+
+/* oidmap_bench.c ends here */
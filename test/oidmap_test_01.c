@@ -0,0 +1,111 @@
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdio.h>
+#include <stdint.h>
+#include "oidmap.h"
+
+#define NOIDS	(20000U)
+
+/* model, oid i is at val[i] */
+static char val[NOIDS];
+static char ins[NOIDS];
+
+static echs_oid_t
+mkoid(size_t i)
+{
+/* oids that only differ in their high bits */
+	return ((echs_oid_t)(i + 1U) << 32U) | 0x1000U;
+}
+
+static unsigned int
+rnd(void)
+{
+	static uint_fast64_t st = 0x2545f4914f6cdd1dULL;
+	st = st * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (unsigned int)(st >> 33U);
+}
+
+static size_t
+check(oidmap_t m)
+{
+	size_t nbad = 0U;
+	size_t n = 0U;
+	echs_oid_t o;
+	void *v;
+
+	for (size_t i = 0U; i < NOIDS; i++) {
+		v = oidmap_get(m, mkoid(i));
+		nbad += v != (ins[i] ? val + i : NULL);
+		n += ins[i];
+	}
+	nbad += oidmap_size(m) != n;
+	for (oidmap_iter_t i = 0U; (v = oidmap_next(&i, m, &o)) != NULL; n--) {
+		const size_t k = (char*)v - val;
+		nbad += k >= NOIDS || mkoid(k) != o || !ins[k];
+	}
+	nbad += n != 0U;
+	return nbad;
+}
+
+int
+main(void)
+{
+	oidmap_t m = make_oidmap(0U);
+	size_t nbad = 0U;
+
+	/* the empty map */
+	nbad += oidmap_get(m, mkoid(0U)) != NULL;
+	nbad += oidmap_del(m, mkoid(0U)) != NULL;
+	/* 0 isn't a valid oid */
+	nbad += oidmap_put(m, 0U, val) != -1;
+	nbad += check(m);
+	printf("empty %zu\n", nbad);
+
+	for (size_t i = 0U; i < NOIDS; i++) {
+		nbad += oidmap_put(m, mkoid(i), val + i) < 0;
+		ins[i] = 1;
+	}
+	/* reput some */
+	for (size_t i = 0U; i < NOIDS; i += 5U) {
+		nbad += oidmap_put(m, mkoid(i), val + i) < 0;
+	}
+	nbad += check(m);
+	/* it started out with 16 cells */
+	nbad += !oidmap_ngrow(m);
+	printf("filled %zu %zu\n", oidmap_size(m), nbad);
+
+	/* random erase and insert */
+	for (size_t j = 0U; j < 10U * NOIDS; j++) {
+		const size_t i = rnd() % NOIDS;
+
+		if (ins[i]) {
+			nbad += oidmap_del(m, mkoid(i)) != val + i;
+			ins[i] = 0;
+		} else {
+			nbad += oidmap_put(m, mkoid(i), val + i) < 0;
+			ins[i] = 1;
+		}
+	}
+	nbad += check(m);
+	printf("churned %zu\n", nbad);
+
+	for (size_t i = 0U; i < NOIDS; i++) {
+		nbad += oidmap_del(m, mkoid(i)) != (ins[i] ? val + i : NULL);
+		ins[i] = 0;
+	}
+	nbad += check(m);
+	printf("emptied %zu %zu\n", oidmap_size(m), nbad);
+
+	/* fill it up again and clear it in one go */
+	for (size_t i = 0U; i < NOIDS; i += 3U) {
+		nbad += oidmap_put(m, mkoid(i), val + i) < 0;
+	}
+	oidmap_clr(m);
+	nbad += check(m);
+	printf("cleared %zu %zu\n", oidmap_size(m), nbad);
+	free_oidmap(m);
+	return nbad > 0U;
+}
+
+/* oidmap_test_01.c ends here */
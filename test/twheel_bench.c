@@ -0,0 +1,158 @@
+/* steady-state benchmark of the timing wheel vs a binary heap
+ * (which is what libev uses for its timers), each of N tasks recurs
+ * at a random interval between a minute and a day and we simulate
+ * a week's worth of runs, build with `make twheel_bench' */
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "twheel.h"
+
+#define T0	(1400000000U)
+#define SPAN	(7U * 86400U)
+
+struct task_s {
+	struct twnode_s w;
+	unsigned int ival;
+	/* heap bookkeeping */
+	twtick_t at;
+};
+
+static unsigned int
+rnd(void)
+{
+	static uint_fast64_t st = 0x2545f4914f6cdd1dULL;
+	st = st * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (unsigned int)(st >> 33U);
+}
+
+static double
+cpu(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+static long
+maxrss(void)
+{
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+static struct task_s*
+mk_tasks(size_t n)
+{
+	struct task_s *t = calloc(n, sizeof(*t));
+
+	for (size_t i = 0U; i < n; i++) {
+		t[i].ival = 60U + rnd() % 86400U;
+		t[i].at = T0 + 1U + rnd() % t[i].ival;
+	}
+	return t;
+}
+
+static size_t
+bench_wheel(struct task_s *t, size_t n)
+{
+	twheel_t w = make_twheel(T0);
+	size_t nrun = 0U;
+
+	for (size_t i = 0U; i < n; i++) {
+		twheel_add(w, &t[i].w, t[i].at);
+	}
+	for (twtick_t to; (to = twheel_timeout(w)) != TWHEEL_NEVER;) {
+		const twtick_t now = twheel_now(w) + to;
+
+		if (now > T0 + SPAN) {
+			break;
+		}
+		twheel_advance(w, now);
+		for (struct twnode_s *x; (x = twheel_pop(w)) != NULL; nrun++) {
+			struct task_s *y = (void*)x;
+			twheel_add(w, x, x->when + y->ival);
+		}
+	}
+	free_twheel(w);
+	return nrun;
+}
+
+static void
+sift_down(struct task_s **h, size_t n, size_t i)
+{
+	struct task_s *x = h[i];
+
+	for (size_t c; (c = 2U * i + 1U) < n; i = c) {
+		if (c + 1U < n && h[c + 1U]->at < h[c]->at) {
+			c++;
+		}
+		if (x->at <= h[c]->at) {
+			break;
+		}
+		h[i] = h[c];
+	}
+	h[i] = x;
+	return;
+}
+
+static size_t
+bench_heap(struct task_s *t, size_t n)
+{
+	struct task_s **h = malloc(n * sizeof(*h));
+	size_t nrun = 0U;
+
+	for (size_t i = 0U; i < n; i++) {
+		h[i] = t + i;
+	}
+	for (size_t i = n / 2U; i-- > 0U;) {
+		sift_down(h, n, i);
+	}
+	while (h[0U]->at <= T0 + SPAN) {
+		h[0U]->at += h[0U]->ival;
+		sift_down(h, n, 0U);
+		nrun++;
+	}
+	free(h);
+	return nrun;
+}
+
+int
+main(void)
+{
+	static const size_t ns[] = {10000U, 100000U, 1000000U};
+
+	printf("%8s  %10s  %10s  %10s  %10s  %10s\n",
+	       "tasks", "runs", "wheel/s", "heap/s", "wheel/MB", "maxrss/kB");
+	for (size_t i = 0U; i < sizeof(ns) / sizeof(*ns); i++) {
+		struct task_s *t = mk_tasks(ns[i]);
+		struct task_s *u = malloc(ns[i] * sizeof(*u));
+		size_t nw, nh;
+		double c0, c1, c2;
+
+		memcpy(u, t, ns[i] * sizeof(*u));
+		c0 = cpu();
+		nw = bench_wheel(t, ns[i]);
+		c1 = cpu();
+		nh = bench_heap(u, ns[i]);
+		c2 = cpu();
+		if (nw != nh) {
+			fprintf(stderr, "run counts differ %zu v %zu\n", nw, nh);
+		}
+		printf("%8zu  %10zu  %10.3f  %10.3f  %10.1f  %10ld\n",
+		       ns[i], nw, c1 - c0, c2 - c1,
+		       (double)(ns[i] * sizeof(struct twnode_s)) / 1000000,
+		       maxrss());
+		free(t);
+		free(u);
+	}
+	return 0;
+}
+
+/* twheel_bench.c ends here */
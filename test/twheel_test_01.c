@@ -0,0 +1,118 @@
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdio.h>
+#include <stdint.h>
+#include "twheel.h"
+
+#define countof(x)	(sizeof(x) / sizeof(*x))
+
+static struct twnode_s n[4096U];
+
+static unsigned int
+rnd(void)
+{
+	static uint_fast64_t st = 0x2545f4914f6cdd1dULL;
+	st = st * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (unsigned int)(st >> 33U);
+}
+
+static size_t
+drain(twheel_t w, twtick_t now, int verbp)
+{
+	size_t nbad = 0U;
+
+	for (struct twnode_s *x; (x = twheel_pop(w)) != NULL;) {
+		if (verbp) {
+			printf("%zu expired %lu at %lu\n",
+			       x - n, (unsigned long)x->when,
+			       (unsigned long)now);
+		}
+		nbad += x->when != now;
+	}
+	return nbad;
+}
+
+static size_t
+run(twheel_t w, int verbp)
+{
+/* advance W by its own timeouts until empty, return number of
+ * nodes that didn't expire exactly on time */
+	size_t nbad = 0U;
+
+	for (twtick_t to; (to = twheel_timeout(w)) != TWHEEL_NEVER;) {
+		const twtick_t now = twheel_now(w) + to;
+
+		twheel_advance(w, now);
+		nbad += drain(w, now, verbp);
+	}
+	return nbad;
+}
+
+int
+main(void)
+{
+	static const twtick_t t[] = {
+		1000U, 1001U, 1063U, 1064U, 1065U, 4095U, 4096U, 5000U,
+		1000000U, 1000001U, 100000000000ULL,
+	};
+	twheel_t w;
+	size_t nbad = 0U;
+
+	w = make_twheel(999U);
+	for (size_t i = 0U; i < countof(t); i++) {
+		twheel_add(w, n + i, t[i]);
+	}
+	/* cancel one, move one */
+	twheel_del(w, n + 2U);
+	twheel_add(w, n + 4U, 1002U);
+	/* deleting twice must be harmless */
+	twheel_del(w, n + 2U);
+	printf("size %zu\n", twheel_size(w));
+	nbad += run(w, 1);
+	printf("size %zu\n", twheel_size(w));
+	/* stuff in the past is due immediately */
+	twheel_add(w, n + 0U, 5U);
+	printf("timeout %lu\n", (unsigned long)twheel_timeout(w));
+	nbad += drain(w, 5U, 1);
+	free_twheel(w);
+
+	/* random schedule with random cancellations and big jumps */
+	w = make_twheel(1400000000U);
+	for (size_t i = 0U; i < countof(n); i++) {
+		const twtick_t base = 1400000000U;
+		twtick_t d = rnd() % 86400U;
+
+		if (i % 7U == 0U) {
+			d *= 1000U;
+		}
+		twheel_add(w, n + i, base + 1U + d);
+	}
+	for (size_t i = 0U; i < countof(n); i += 3U) {
+		twheel_del(w, n + i);
+	}
+	printf("size %zu\n", twheel_size(w));
+	/* jump ahead and see that everything until then is due */
+	{
+		const twtick_t now = 1400000000U + 43200U;
+		size_t ndue = 0U, nexp = 0U;
+
+		for (size_t i = 0U; i < countof(n); i++) {
+			nexp += twnode_linked_p(n + i) && n[i].when <= now;
+		}
+		twheel_advance(w, now);
+		for (struct twnode_s *x; (x = twheel_pop(w)) != NULL;) {
+			nbad += x->when > now;
+			ndue++;
+		}
+		printf("due %s\n", ndue == nexp ? "ok" : "not ok");
+	}
+	nbad += run(w, 0);
+	printf("size %zu\n", twheel_size(w));
+	free_twheel(w);
+
+	printf("bad %zu\n", nbad);
+	return nbad > 0U;
+}
+
+/* twheel_test_01.c ends here */